@@ -38,7 +38,7 @@ $(OUTD):
 	mkdir -p $(OUTD)
 
 $(OUTD)/$(name) : $(OUTD)/main.o $(proj_obj)
-	$(CC) $(OUTD)/main.o $(proj_obj) -o $@ -Wl,-Map,$(TARGET1).map
+	$(CC) $(OUTD)/main.o $(proj_obj) -o $@ -Wl,-Map,$(TARGET1).map -pthread
 
 $(OUTD)/msgtext.o: src/msgtext.c src/H/msgdef.h
 	$(CC) -c $(inc_dirs) $(c_flags) -o $(OUTD)/msgtext.o src/msgtext.c
@@ -46,6 +46,27 @@ $(OUTD)/msgtext.o: src/msgtext.c src/H/msgdef.h
 $(OUTD)/reswords.o: src/reswords.c src/H/instruct.h src/H/special.h src/H/directve.h
 	$(CC) -c $(inc_dirs) $(c_flags) -o $(OUTD)/reswords.o src/reswords.c
 
+# v2.21: libjwasm.so; the objects are compiled with -fPIC in a separate directory
+
+LIBD=$(OUTD)/lib
+lib_obj = $(proj_obj:$(OUTD)/%=$(LIBD)/%) $(LIBD)/jwlib.o
+
+lib: $(LIBD) $(OUTD)/libjwasm.so
+
+$(LIBD):
+	mkdir -p $(LIBD)
+
+$(LIBD)/%.o: src/%.c
+	$(CC) -c $(inc_dirs) $(c_flags) -fPIC -fvisibility=hidden -o $@ $<
+
+$(OUTD)/libjwasm.so : $(lib_obj)
+	$(CC) -shared $(lib_obj) -o $@ -pthread
+
+bench: lib $(OUTD)/JWasmLib
+
+$(OUTD)/JWasmLib : Samples/JWasmLib.c $(OUTD)/libjwasm.so
+	$(CC) $(inc_dirs) -O2 Samples/JWasmLib.c -o $@ -L$(OUTD) -ljwasm -Wl,-rpath,'$$ORIGIN'
+
 ######
 
 install:
@@ -55,3 +76,5 @@ clean:
 	@rm -f $(OUTD)/$(name)
 	@rm -f $(OUTD)/*.o
 	@rm -f $(OUTD)/$(name).map
+	@rm -f $(OUTD)/libjwasm.so $(OUTD)/JWasmLib
+	@rm -rf $(LIBD)
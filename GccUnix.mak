@@ -40,16 +40,50 @@ $(OUTD):
 
 $(OUTD)/$(TARGET1) : $(OUTD)/main.o $(proj_obj)
 ifeq ($(DEBUG),0)
-	$(CC) $(OUTD)/main.o $(proj_obj) -s -o $@ -Wl,-Map,$(OUTD)/$(TARGET1).map
+	$(CC) $(OUTD)/main.o $(proj_obj) -s -o $@ -Wl,-Map,$(OUTD)/$(TARGET1).map -pthread
 else
-	$(CC) $(OUTD)/main.o $(proj_obj) -o $@ -Wl,-Map,$(OUTD)/$(TARGET1).map
+	$(CC) $(OUTD)/main.o $(proj_obj) -o $@ -Wl,-Map,$(OUTD)/$(TARGET1).map -pthread
 endif
 
 $(OUTD)/msgtext.o: src/msgtext.c src/H/msgdef.h
 	$(CC) -c $(inc_dirs) $(c_flags) -o $*.o src/msgtext.c
 
-$(OUTD)/reswords.o: src/reswords.c src/H/instruct.h src/H/special.h src/H/directve.h src/H/opndcls.h src/H/instravx.h
-	$(CC) -c $(inc_dirs) $(c_flags) -o $*.o src/reswords.c
+# v2.21: the static table of the reserved words is created by mkreswh
+
+resw_deps = src/reswords.c src/H/instruct.h src/H/special.h src/H/directve.h src/H/opndcls.h src/H/instravx.h src/H/instr64.h
+
+$(OUTD)/mkreswh: $(resw_deps)
+	$(CC) $(inc_dirs) $(c_flags) -UDEBUG_OUT -DMKRESWH -o $@ src/reswords.c
+
+$(OUTD)/reswh.h: $(OUTD)/mkreswh
+	$(OUTD)/mkreswh > $@.tmp && mv $@.tmp $@
+
+$(OUTD)/reswords.o: $(resw_deps) $(OUTD)/reswh.h
+	$(CC) -c $(inc_dirs) -I$(OUTD) $(c_flags) -DRESWH -o $*.o src/reswords.c
+
+# v2.21: libjwasm.so; the objects are compiled with -fPIC in a separate directory
+
+LIBD=$(OUTD)/lib
+lib_obj = $(proj_obj:$(OUTD)/%=$(LIBD)/%) $(LIBD)/jwlib.o
+
+lib: $(LIBD) $(OUTD)/libjwasm.so
+
+$(LIBD):
+	mkdir -p $(LIBD)
+
+$(LIBD)/%.o: src/%.c
+	$(CC) -c $(inc_dirs) $(c_flags) -fPIC -fvisibility=hidden -o $@ $<
+
+$(LIBD)/reswords.o: $(resw_deps) $(OUTD)/reswh.h
+	$(CC) -c $(inc_dirs) -I$(OUTD) $(c_flags) -DRESWH -fPIC -fvisibility=hidden -o $@ src/reswords.c
+
+$(OUTD)/libjwasm.so : $(lib_obj)
+	$(CC) -shared $(lib_obj) -o $@ -pthread
+
+bench: lib $(OUTD)/JWasmLib
+
+$(OUTD)/JWasmLib : Samples/JWasmLib.c $(OUTD)/libjwasm.so
+	$(CC) $(inc_dirs) -O2 Samples/JWasmLib.c -o $@ -L$(OUTD) -ljwasm -Wl,-rpath,'$$ORIGIN'
 
 ######
 
@@ -60,4 +94,7 @@ clean:
 	@rm -f $(OUTD)/$(TARGET1)
 	@rm -f $(OUTD)/*.o
 	@rm -f $(OUTD)/*.map
+	@rm -f $(OUTD)/libjwasm.so $(OUTD)/JWasmLib
+	@rm -f $(OUTD)/mkreswh $(OUTD)/reswh.h
+	@rm -rf $(LIBD)
 
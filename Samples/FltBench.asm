@@ -0,0 +1,39 @@
+
+;--- benchmark for the conversion of float initializers ( REAL4/REAL8 ).
+;--- 500000 items: 17 significant digits, 6 decimals, with exponent.
+;---   assemble: jwasm -bin FltBench.asm
+;--- JWasm displays the time needed.
+
+    .386
+    .model flat
+    .data
+
+    REPEAT 2000
+    real8 0.47942553860420301, 0.99749498660405445, 0.59847214410395655, -0.35078322768961984, -0.97753011766509701, -0.70554032557039192, 0.21511998808781552, 0.9379999767747389, 0.79848711262349026, -0.075151120461809301
+    real8 -0.87969575997167004, -0.87545217468842851, -0.066321897351200684, 0.80378442655162097, 0.93489505552468299, 0.2064674819377966, -0.71178534236912305, -0.97562600546815759, -0.34248061846961253, 0.60553986971960105
+    real8 0.99682979427879925, 0.47163900309419615, -0.48717451246050952, -0.99808202797939627, -0.59135752986512435, 0.35905835402216829, 0.97935764310391704, 0.69924003165509774, -0.22375564018679642, -0.94103140834295351
+    real8 -0.79312723945728514, 0.08397445569174683, 0.88387042354583067, 0.87114000016917637, 0.057487478104924564, -0.80901876621190649, -0.93171688785470552, -0.19779879963646227, 0.7179745927716441, 0.97364545569497807
+    real8 0.33415117684842055, -0.61256015297546973, -0.99608650311959401, -0.46381551598382736, 0.4948853175526281, 0.99859087241177047, 0.58419658441328559, -0.36730534913419133, -0.98110843860309704, -0.69288495423369567
+    real8 0.23237376165548454, 0.94398911272511932, 0.78770522698411793, -0.092791211757308686, -0.88797583833766336, -0.86675957426075922, -0.048648554875087263, 0.81418972150843449, 0.92846572276537864, 0.18911462035089152
+    real8 -0.72410759186744955, -0.9715886235161092, -0.32579555541456173, 0.61953244385195116, 0.99526517136122772, 0.45595569022148996, -0.50255734976048727, -0.99902148003463498, -0.57698986878854264, 0.37552356689662503
+    real8 0.98278236699269284, 0.68647559120877555, -0.2409736772881011, -0.94687285819334754, -0.7822215000035424, 0.1016006978902495, 0.89201168269937048, 0.86231124015732896, 0.039805820166669656, -0.81929688731128081
+    real8 -0.92514181497641845, -0.1804156244623088, 0.73018385915316686, 0.96945567007861488, 0.31741440880766936, -0.62645619608950265, -0.9943658633527529, -0.44806014160260915, 0.51019000800176306, 0.99937381711108364
+    real8 0.56973794761696306, -0.38371236343503057, -0.98437929712508443, -0.68001244473605282, 0.24955471330524379, 0.94968241881422433, 0.7766764881502719, -0.11040222389190282, -0.89597764043380335, -0.857795346373455
+    real8 1.000000, 0.540302, -0.416147, -0.989992, -0.653644, 0.283662, 0.960170, 0.753902, -0.145500, -0.911130
+    real8 -0.839072, 0.004426, 0.843854, 0.907447, 0.136737, -0.759688, -0.957659, -0.275163, 0.660317, 0.988705
+    real8 0.408082, -0.547729, -0.999961, -0.532833, 0.424179, 0.991203, 0.646919, -0.292139, -0.962606, -0.748058
+    real8 0.154251, 0.914742, 0.834223, -0.013277, -0.848570, -0.903692, -0.127964, 0.765414, 0.955074, 0.266643
+    real8 -0.666938, -0.987339, -0.399985, 0.555113, 0.999843, 0.525322, -0.432178, -0.992335, -0.640144, 0.300593
+    real8 0.964966, 0.742154, -0.162991, -0.918283, -0.829310, 0.022127, 0.853220, 0.899867, 0.119180, -0.771080
+    real8 -0.952413, -0.258102, 0.673507, 0.985897, 0.391857, -0.562454, -0.999647, -0.517770, 0.440143, 0.993390
+    real8 0.633319, -0.309023, -0.967251, -0.736193, 0.171717, 0.921751, 0.824331, -0.030975, -0.857803, -0.895971
+    real8 -0.110387, 0.776686, 0.949678, 0.249540, -0.680023, -0.984377, -0.383698, 0.569750, 0.999373, 0.510177
+    real8 -0.448074, -0.994367, -0.626444, 0.317429, 0.969459, 0.730174, -0.180430, -0.925148, -0.819288, 0.039821
+    real4 1.42857143e-01, 3.88325975e-01, 1.05557944e+00, 2.86936242e+00, 7.79973572e+00, 2.12018799e+01, 5.76326848e+01, 1.56661880e+02, 4.25851141e+02, 1.15758342e+03
+    real4 3.14663797e+03, 8.55344882e+03, 2.32506845e+04, 6.32019131e+04, 1.71800612e+05, 4.67002482e+05, 1.26944436e+06, 3.45070754e+06, 9.37999559e+06, 2.54974716e+07
+    real4 6.93093136e+07, 1.88402248e+08, 5.12130407e+08, 1.39211478e+09, 3.78416030e+09, 1.02864142e+10, 2.79613728e+10, 7.60068915e+10, 2.06608152e+11, 5.61619185e+11
+    real4 1.52663923e+12, 4.14983567e+12, 1.12804229e+13, 3.06633685e+13, 8.33516775e+13, 2.26573350e+14, 6.15890221e+14, 1.67416320e+15, 4.55084739e+15, 1.23704858e+16
+    real4 3.36264667e+16, 9.14062134e+16, 2.48467849e+17, 6.75405638e+17, 1.83594287e+18, 4.99061015e+18, 1.35658849e+19, 3.68758984e+19, 1.00239084e+20, 2.72478082e+20
+    ENDM
+
+    end
@@ -0,0 +1,73 @@
+/*
+ * Benchmark for libjwasm.so: assembles small generated snippets in
+ * memory and displays the number of snippets per second.
+ *
+ * To create the binary (GCC, Linux):
+ *    make -f GccUnix.mak bench
+ * or
+ *    gcc -I../src/H -o JWasmLib JWasmLib.c -L<dir> -ljwasm
+ *
+ * usage: JWasmLib [count [options]]
+ *    count:   number of snippets, default 10000
+ *    options: JWasm options, default "-elf64"; the snippets are 64-bit
+ *             code, so the output format must be -elf64 or -win64.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "jwlib.h"
+
+static const char *tmpl =
+    "    .code\n"
+    "snippet%u proc\n"
+    "    mov eax, %u\n"
+    "    add eax, ecx\n"
+    "    .if eax > %u\n"
+    "        shl eax, 2\n"
+    "    .else\n"
+    "        lea eax, [eax+eax*2+%u]\n"
+    "    .endif\n"
+    "    ret\n"
+    "snippet%u endp\n"
+    "    end\n";
+
+int main( int argc, char **argv )
+{
+    static char src[1024];
+    static unsigned char out[0x10000];
+    static char msgs[0x1000];
+    unsigned count = 10000;
+    const char *options = "-elf64";
+    struct timespec start, end;
+    size_t outsize = 0;
+    size_t msgsize;
+    size_t srcsize;
+    double secs;
+    unsigned i;
+    int rc;
+
+    if ( argc > 1 )
+        count = strtoul( argv[1], NULL, 0 );
+    if ( argc > 2 )
+        options = argv[2];
+
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    for ( i = 0; i < count; i++ ) {
+        srcsize = sprintf( src, tmpl, i, i, i * 3, i & 0x7f, i );
+        outsize = sizeof( out );
+        msgsize = sizeof( msgs );
+        rc = JWasmAssemble( options, NULL, src, srcsize, out, &outsize, msgs, &msgsize );
+        if ( rc != JWLIB_OK || ( i == 0 && msgsize ) ) {
+            printf( "snippet %u: JWasmAssemble() returned %d\n%s", i, rc, msgs );
+            return( 1 );
+        }
+    }
+    clock_gettime( CLOCK_MONOTONIC, &end );
+
+    secs = ( end.tv_sec - start.tv_sec ) + ( end.tv_nsec - start.tv_nsec ) / 1e9;
+    printf( "%u snippets in %.3f s: %.0f snippets/s, %u bytes per module\n",
+           count, secs, secs > 0 ? count / secs : 0.0, (unsigned)outsize );
+    return( 0 );
+}
@@ -0,0 +1,302 @@
+/* generated by mkreswh - do not edit */
+
+#if PH_SLOTBITS != 11 || PH_BUCKETBITS != 9
+#error reswh.h is outdated
+#endif
+
+/* fails if ResWordTable[] has changed */
+typedef char reswh_check[ ( sizeof( ResWordTable ) / sizeof( ResWordTable[0] ) == 1365 ) ? 1 : -1 ];
+
+static const uint_16 perf_disp[PH_BUCKETS] = {
+1,0,0,12,1,0,4,1,6,0,0,1,0,3,1,0,
+2,2,2,0,0,0,0,0,2,0,8,0,0,2,1,0,
+2,6,2,3,1,0,0,0,2,4,1,1,0,0,1,0,
+2,2,4,1,1,11,3,10,0,1,11,1,1,0,2,2,
+1,3,1,0,3,2,2,16,1,0,0,2,0,6,0,2,
+1,18,1,15,0,6,6,18,1,4,16,1,1,3,1,1,
+0,2,1,0,0,0,1,1,2,0,1,0,1,0,5,0,
+10,0,5,5,1,0,2,1,0,0,0,6,0,3,2,6,
+1,1,3,4,3,1,2,2,5,4,0,6,0,12,0,0,
+1,0,0,0,0,4,5,0,0,0,10,1,0,3,9,0,
+0,4,0,0,1,2,0,7,0,0,2,1,2,2,0,5,
+0,2,2,0,0,0,4,0,6,7,2,0,2,0,3,2,
+0,0,0,1,2,1,2,4,10,4,1,0,0,2,5,4,
+1,0,1,5,9,4,0,0,8,0,20,3,1,0,1,1,
+6,2,0,1,2,3,3,9,0,12,1,0,6,7,0,0,
+3,0,7,3,3,0,5,1,2,0,2,0,10,4,1,1,
+8,0,12,0,2,2,1,2,0,0,0,8,4,2,9,0,
+0,1,0,1,9,0,0,2,1,0,0,8,10,0,0,2,
+1,16,1,1,3,14,0,0,0,0,0,3,3,0,1,1,
+0,1,1,3,0,0,4,6,5,1,0,1,2,2,12,3,
+0,0,7,3,1,0,3,0,2,15,3,0,1,6,0,16,
+1,0,0,0,0,12,15,0,2,3,4,4,31,0,0,1,
+7,0,3,1,0,3,10,8,0,3,13,1,4,3,0,4,
+2,10,1,10,9,0,0,0,3,3,1,0,1,2,2,4,
+1,0,3,20,7,1,0,6,1,0,1,1,7,4,0,3,
+2,18,23,1,42,5,19,1,16,26,7,28,13,0,1,3,
+3,2,11,1,0,3,0,0,0,4,3,0,0,6,4,14,
+1,10,4,0,2,9,0,0,1,1,1,2,0,15,7,1,
+8,7,11,1,17,0,0,5,1,1,3,0,4,4,4,1,
+10,1,2,1,0,10,2,4,0,0,5,0,4,10,4,4,
+4,4,1,0,5,4,1,15,0,2,0,3,10,1,1,9,
+2,4,14,2,2,3,0,4,0,2,2,1,2,1,0,6,
+};
+
+static const struct perf_item perf_table[PH_SLOTS] = {
+{0,0},{0,0},{0,0},{0,0},{99,3},{0,0},{1331,6},{195,5},
+{0,0},{409,5},{0,0},{329,2},{0,0},{0,0},{8,2},{153,6},
+{205,4},{0,0},{1020,9},{708,7},{315,5},{0,0},{0,0},{39,3},
+{242,6},{169,10},{279,6},{280,7},{1357,7},{863,8},{446,4},{0,0},
+{1145,6},{594,5},{1259,8},{160,6},{1348,5},{9,2},{920,8},{1326,6},
+{0,0},{317,5},{0,0},{258,5},{0,0},{0,0},{0,0},{432,3},
+{738,4},{584,4},{0,0},{1109,6},{7,2},{0,0},{0,0},{993,5},
+{0,0},{1314,7},{868,4},{1293,9},{0,0},{527,3},{0,0},{918,6},
+{45,4},{0,0},{0,0},{1083,6},{0,0},{0,0},{90,4},{0,0},
+{386,4},{579,3},{825,8},{264,5},{548,6},{0,0},{270,5},{800,5},
+{1262,8},{1313,7},{724,5},{562,3},{307,10},{208,5},{0,0},{639,6},
+{1362,9},{521,5},{0,0},{1111,6},{1306,9},{0,0},{21,3},{0,0},
+{0,0},{593,4},{1209,5},{0,0},{1342,10},{201,5},{912,7},{24,3},
+{1345,10},{695,7},{123,4},{0,0},{0,0},{0,0},{911,7},{0,0},
+{283,2},{401,3},{1124,9},{0,0},{857,8},{524,3},{0,0},{40,4},
+{449,5},{882,7},{1069,6},{1107,7},{934,5},{0,0},{541,3},{1112,7},
+{1175,7},{271,5},{0,0},{50,4},{0,0},{25,2},{58,3},{0,0},
+{0,0},{77,4},{1017,6},{0,0},{254,7},{1048,4},{126,5},{0,0},
+{1304,9},{1248,6},{804,7},{56,3},{601,5},{611,4},{0,0},{700,6},
+{113,3},{3,2},{0,0},{1029,5},{860,8},{405,4},{991,5},{377,2},
+{1235,9},{1044,7},{1113,12},{0,0},{422,7},{0,0},{0,0},{1159,7},
+{707,7},{1268,7},{1081,8},{0,0},{191,7},{0,0},{467,3},{0,0},
+{745,6},{224,7},{211,4},{0,0},{0,0},{674,5},{837,5},{1165,6},
+{0,0},{922,6},{433,3},{971,8},{774,5},{1277,8},{608,5},{480,6},
+{0,0},{966,8},{0,0},{846,8},{0,0},{373,4},{0,0},{940,6},
+{440,5},{513,3},{865,8},{0,0},{154,7},{714,4},{0,0},{1330,6},
+{1332,6},{0,0},{66,3},{1280,7},{0,0},{250,8},{0,0},{0,0},
+{995,7},{0,0},{1101,6},{71,3},{992,6},{1226,9},{0,0},{557,4},
+{496,4},{0,0},{381,2},{227,9},{1236,9},{517,3},{595,4},{0,0},
+{407,5},{1129,10},{125,5},{733,6},{0,0},{776,5},{104,3},{394,4},
+{553,5},{0,0},{0,0},{678,5},{82,4},{1141,6},{0,0},{982,5},
+{0,0},{438,3},{663,6},{0,0},{106,3},{1133,8},{822,8},{233,8},
+{0,0},{858,9},{1305,8},{665,4},{816,8},{364,4},{927,6},{0,0},
+{1184,10},{1135,9},{309,3},{0,0},{958,5},{1249,6},{686,5},{0,0},
+{1335,6},{369,4},{1299,9},{789,5},{0,0},{0,0},{775,5},{829,10},
+{877,6},{0,0},{1196,5},{0,0},{1073,8},{0,0},{646,5},{507,3},
+{0,0},{221,7},{1228,7},{0,0},{1170,7},{0,0},{0,0},{0,0},
+{300,9},{268,8},{1192,9},{0,0},{95,4},{0,0},{1286,7},{1105,7},
+{605,5},{718,7},{55,4},{930,7},{897,5},{1257,8},{907,7},{0,0},
+{70,3},{0,0},{662,6},{0,0},{0,0},{0,0},{352,4},{1176,6},
+{0,0},{941,5},{388,4},{1010,5},{1110,7},{478,5},{0,0},{374,3},
+{0,0},{476,5},{919,6},{0,0},{1203,6},{262,6},{0,0},{91,3},
+{0,0},{486,4},{500,4},{321,7},{0,0},{0,0},{472,3},{0,0},
+{328,2},{1070,8},{295,4},{434,3},{598,6},{1207,7},{0,0},{178,2},
+{0,0},{0,0},{1199,7},{0,0},{134,4},{620,6},{1132,9},{1169,6},
+{1258,8},{879,6},{0,0},{75,3},{0,0},{1036,5},{327,2},{965,7},
+{267,6},{148,3},{753,4},{0,0},{0,0},{0,0},{0,0},{273,6},
+{1220,6},{1232,6},{1050,8},{1310,8},{1193,8},{632,6},{1185,9},{0,0},
+{1284,7},{951,9},{1328,6},{1031,10},{14,2},{455,4},{1271,7},{458,5},
+{1106,7},{0,0},{10,2},{0,0},{0,0},{137,6},{0,0},{0,0},
+{1013,7},{0,0},{65,3},{483,5},{805,10},{81,4},{31,2},{1311,7},
+{343,7},{158,8},{626,6},{357,5},{0,0},{545,4},{913,6},{170,3},
+{0,0},{0,0},{1318,7},{565,5},{0,0},{229,7},{727,5},{702,7},
+{20,3},{0,0},{955,9},{28,2},{0,0},{0,0},{1072,8},{0,0},
+{1167,6},{124,4},{1002,6},{765,6},{0,0},{762,7},{0,0},{1279,10},
+{0,0},{0,0},{1252,10},{1321,7},{592,4},{395,3},{182,2},{165,8},
+{420,6},{667,4},{821,10},{0,0},{0,0},{0,0},{53,4},{1291,7},
+{1295,9},{0,0},{660,7},{248,5},{0,0},{894,8},{0,0},{683,5},
+{222,5},{0,0},{320,5},{862,8},{1217,7},{0,0},{0,0},{554,3},
+{895,5},{0,0},{230,6},{544,6},{787,5},{1219,6},{0,0},{0,0},
+{932,5},{278,5},{1015,7},{0,0},{0,0},{213,4},{597,5},{1018,7},
+{1188,9},{0,0},{0,0},{730,5},{840,6},{696,7},{1266,7},{1088,7},
+{1264,7},{0,0},{1260,8},{891,5},{1063,6},{239,5},{902,7},{1118,11},
+{0,0},{1338,8},{0,0},{0,0},{0,0},{0,0},{0,0},{93,4},
+{641,5},{88,4},{813,10},{703,5},{899,6},{712,5},{474,3},{0,0},
+{487,4},{612,4},{0,0},{0,0},{0,0},{1300,9},{1158,7},{621,5},
+{354,5},{64,3},{1019,6},{856,8},{15,2},{387,3},{0,0},{351,4},
+{0,0},{0,0},{0,0},{402,3},{946,6},{36,3},{161,8},{835,6},
+{690,3},{984,6},{290,6},{425,3},{0,0},{1301,9},{228,7},{1187,9},
+{0,0},{0,0},{0,0},{135,5},{359,7},{356,3},{0,0},{1256,8},
+{843,5},{0,0},{1202,9},{0,0},{752,4},{559,5},{1120,10},{0,0},
+{0,0},{0,0},{1234,9},{0,0},{0,0},{737,5},{990,7},{0,0},
+{0,0},{754,7},{257,9},{1005,7},{711,6},{223,8},{572,4},{0,0},
+{643,6},{0,0},{0,0},{0,0},{0,0},{192,7},{0,0},{481,6},
+{1066,6},{168,6},{465,5},{0,0},{845,8},{886,7},{784,5},{423,3},
+{498,3},{1354,8},{133,5},{1054,8},{502,4},{287,5},{890,6},{0,0},
+{0,0},{136,5},{174,4},{693,7},{0,0},{0,0},{629,6},{0,0},
+{583,4},{501,3},{0,0},{0,0},{0,0},{603,5},{0,0},{1221,8},
+{62,3},{0,0},{1137,6},{530,3},{49,4},{0,0},{0,0},{1204,8},
+{896,5},{961,7},{1007,8},{624,6},{715,6},{761,7},{0,0},{0,0},
+{1253,10},{1290,7},{698,8},{552,3},{1057,6},{0,0},{680,5},{336,8},
+{769,10},{1347,11},{1,2},{688,3},{0,0},{103,3},{330,2},{508,3},
+{0,0},{0,0},{808,8},{155,5},{349,6},{159,8},{976,5},{0,0},
+{0,0},{1364,9},{0,0},{1205,8},{404,2},{63,3},{0,0},{687,4},
+{0,0},{0,0},{772,5},{0,0},{0,0},{523,4},{437,3},{658,5},
+{1014,6},{0,0},{917,6},{368,10},{0,0},{0,0},{0,0},{514,3},
+{1115,14},{0,0},{499,3},{1225,9},{676,6},{820,7},{0,0},{186,4},
+{1076,8},{0,0},{0,0},{0,0},{0,0},{679,6},{0,0},{759,4},
+{256,6},{277,8},{365,3},{1134,9},{259,7},{127,5},{4,2},{358,4},
+{0,0},{397,3},{0,0},{333,11},{0,0},{1243,8},{319,4},{147,4},
+{582,5},{0,0},{1190,10},{0,0},{1078,8},{0,0},{0,0},{535,9},
+{400,2},{0,0},{1309,7},{0,0},{607,5},{1320,7},{1353,8},{429,3},
+{180,2},{973,7},{0,0},{953,9},{0,0},{0,0},{255,6},{0,0},
+{23,3},{1163,6},{0,0},{1339,8},{1297,9},{948,7},{0,0},{1003,6},
+{1143,6},{791,6},{382,3},{415,6},{536,5},{719,5},{0,0},{234,6},
+{628,7},{57,3},{1281,7},{0,0},{0,0},{0,0},{243,7},{692,7},
+{763,6},{848,8},{73,3},{0,0},{304,7},{931,5},{0,0},{815,8},
+{1155,6},{0,0},{52,4},{1168,6},{348,9},{2,2},{29,2},{461,5},
+{167,6},{0,0},{811,7},{520,3},{1200,7},{850,8},{602,5},{184,3},
+{122,5},{0,0},{0,0},{1241,7},{685,4},{362,6},{493,4},{1090,9},
+{0,0},{1096,6},{285,3},{146,7},{0,0},{198,4},{0,0},{0,0},
+{35,3},{0,0},{0,0},{0,0},{0,0},{570,3},{782,5},{1139,6},
+{750,4},{0,0},{1336,7},{450,5},{739,7},{516,3},{247,6},{1216,7},
+{827,7},{340,5},{47,4},{190,1},{0,0},{885,8},{0,0},{0,0},
+{0,0},{1006,7},{179,2},{0,0},{26,2},{289,5},{644,6},{175,4},
+{0,0},{0,0},{1149,6},{0,0},{699,8},{79,4},{1229,8},{0,0},
+{1087,7},{795,5},{793,6},{0,0},{326,7},{1316,8},{324,6},{1056,7},
+{1212,7},{0,0},{0,0},{569,4},{1053,8},{413,5},{210,5},{832,8},
+{1121,10},{215,5},{844,8},{937,5},{0,0},{0,0},{828,7},{193,6},
+{118,5},{83,3},{589,4},{34,3},{416,7},{0,0},{0,0},{512,3},
+{1296,9},{771,5},{924,7},{16,2},{770,5},{1154,6},{0,0},{0,0},
+{203,5},{633,6},{0,0},{5,2},{705,6},{1055,7},{371,10},{392,4},
+{117,5},{824,8},{0,0},{0,0},{0,0},{42,4},{847,8},{1060,6},
+{0,0},{0,0},{0,0},{0,0},{0,0},{656,5},{585,4},{906,5},
+{1213,8},{802,7},{0,0},{0,0},{974,5},{1089,5},{509,3},{105,3},
+{240,5},{778,5},{1173,5},{0,0},{1231,6},{0,0},{94,4},{355,6},
+{549,4},{477,5},{459,4},{627,6},{261,5},{0,0},{964,7},{0,0},
+{411,6},{200,5},{0,0},{0,0},{0,0},{185,3},{412,6},{0,0},
+{807,8},{0,0},{0,0},{274,7},{0,0},{561,3},{799,5},{0,0},
+{790,5},{391,3},{854,9},{1350,6},{0,0},{925,3},{444,4},{297,7},
+{142,5},{0,0},{101,3},{0,0},{1322,7},{1028,6},{938,5},{0,0},
+{417,7},{0,0},{764,6},{0,0},{872,6},{575,4},{245,6},{928,6},
+{0,0},{1156,7},{0,0},{1218,7},{1075,8},{0,0},{370,6},{0,0},
+{0,0},{1319,7},{1270,7},{969,8},{251,9},{0,0},{533,4},{172,4},
+{1146,6},{0,0},{0,0},{1064,6},{905,5},{0,0},{188,6},{728,4},
+{431,3},{1355,8},{114,3},{430,3},{792,6},{403,2},{0,0},{836,5},
+{0,0},{1119,12},{313,6},{305,8},{0,0},{0,0},{785,5},{744,5},
+{0,0},{0,0},{870,6},{0,0},{1294,9},{0,0},{814,8},{1289,7},
+{1242,7},{0,0},{881,7},{0,0},{216,5},{0,0},{0,0},{0,0},
+{462,5},{0,0},{27,2},{0,0},{0,0},{0,0},{672,6},{0,0},
+{0,0},{246,5},{495,3},{389,3},{460,5},{0,0},{453,5},{1147,6},
+{0,0},{0,0},{1104,6},{0,0},{162,3},{294,6},{0,0},{353,5},
+{0,0},{0,0},{1340,10},{0,0},{904,5},{659,6},{0,0},{670,5},
+{689,4},{13,2},{0,0},{0,0},{102,3},{0,0},{0,0},{219,5},
+{758,7},{586,5},{0,0},{852,9},{291,3},{0,0},{0,0},{1227,7},
+{0,0},{1215,7},{0,0},{0,0},{0,0},{505,4},{96,4},{131,3},
+{578,4},{469,3},{360,4},{781,5},{0,0},{0,0},{1025,6},{1152,6},
+{543,4},{1361,9},{0,0},{0,0},{1100,6},{638,6},{625,5},{383,2},
+{546,5},{0,0},{0,0},{571,4},{0,0},{987,8},{1122,9},{550,3},
+{682,5},{61,3},{235,5},{751,5},{998,8},{19,3},{0,0},{732,4},
+{0,0},{669,4},{0,0},{842,5},{1047,4},{151,5},{253,3},{202,4},
+{318,4},{108,2},{588,5},{22,3},{376,3},{1177,6},{0,0},{0,0},
+{780,5},{441,5},{0,0},{1038,6},{0,0},{0,0},{0,0},{1116,9},
+{900,6},{0,0},{260,6},{855,9},{0,0},{410,5},{384,3},{1024,6},
+{116,4},{1182,9},{466,5},{0,0},{1323,6},{0,0},{0,0},{831,8},
+{0,0},{0,0},{0,0},{636,7},{506,2},{532,4},{1250,8},{0,0},
+{1246,5},{378,3},{766,11},{1012,5},{342,5},{657,6},{1144,6},{341,6},
+{817,8},{0,0},{1151,6},{0,0},{0,0},{0,0},{0,0},{0,0},
+{1179,9},{1356,8},{869,4},{634,7},{0,0},{275,8},{1341,10},{0,0},
+{442,5},{980,7},{490,4},{0,0},{1093,9},{1276,7},{1247,6},{1206,11},
+{936,5},{977,5},{866,10},{217,4},{0,0},{916,6},{884,8},{0,0},
+{177,2},{952,9},{0,0},{0,0},{564,5},{0,0},{41,4},{491,4},
+{1287,7},{311,3},{0,0},{1067,6},{1349,6},{0,0},{372,11},{0,0},
+{1042,6},{301,10},{788,5},{0,0},{723,4},{0,0},{485,4},{112,3},
+{0,0},{163,5},{0,0},{284,3},{0,0},{779,5},{963,6},{1008,8},
+{157,6},{1254,10},{0,0},{334,10},{1000,6},{0,0},{1051,8},{994,5},
+{803,7},{921,7},{935,5},{241,5},{0,0},{798,5},{0,0},{914,6},
+{0,0},{471,3},{609,5},{0,0},{874,6},{615,4},{325,5},{399,2},
+{834,6},{576,8},{0,0},{0,0},{0,0},{86,4},{276,7},{1211,7},
+{0,0},{983,5},{30,2},{436,3},{0,0},{0,0},{149,6},{810,7},
+{529,3},{0,0},{482,6},{923,6},{542,4},{470,3},{120,5},{566,6},
+{0,0},{722,6},{0,0},{489,3},{1085,7},{0,0},{0,0},{0,0},
+{0,0},{0,0},{748,6},{1092,9},{630,7},{0,0},{406,5},{677,5},
+{69,3},{794,6},{0,0},{0,0},{1039,6},{939,6},{1136,6},{0,0},
+{298,7},{335,10},{574,4},{452,5},{757,5},{249,6},{1046,8},{1251,10},
+{0,0},{0,0},{0,0},{1065,6},{1346,10},{997,8},{0,0},{435,3},
+{0,0},{838,4},{366,3},{33,3},{0,0},{1265,7},{54,4},{0,0},
+{231,6},{0,0},{176,5},{999,6},{809,8},{0,0},{339,9},{0,0},
+{0,0},{962,6},{943,5},{618,6},{511,3},{237,13},{959,5},{1240,6},
+{0,0},{1263,7},{970,5},{519,4},{0,0},{1222,9},{0,0},{1292,9},
+{903,4},{0,0},{0,0},{17,3},{697,7},{0,0},{0,0},{0,0},
+{0,0},{0,0},{1186,9},{0,0},{0,0},{0,0},{839,4},{0,0},
+{0,0},{0,0},{1363,9},{332,2},{1009,5},{1273,8},{0,0},{716,5},
+{1021,8},{671,5},{76,3},{926,6},{604,6},{581,6},{494,4},{1032,6},
+{0,0},{617,5},{0,0},{37,3},{0,0},{0,0},{972,9},{337,8},
+{424,2},{1198,7},{1058,6},{0,0},{0,0},{0,0},{0,0},{0,0},
+{473,3},{1082,6},{1160,6},{0,0},{393,3},{0,0},{1023,6},{130,5},
+{0,0},{346,6},{0,0},{92,3},{0,0},{647,6},{1197,10},{0,0},
+{590,5},{1117,9},{606,6},{947,7},{1098,8},{107,2},{12,2},{457,5},
+{0,0},{704,6},{0,0},{468,3},{68,3},{0,0},{0,0},{819,7},
+{463,4},{0,0},{915,7},{893,8},{0,0},{0,0},{0,0},{746,7},
+{197,5},{0,0},{587,4},{706,6},{225,7},{0,0},{0,0},{0,0},
+{0,0},{889,7},{0,0},{760,7},{0,0},{0,0},{379,2},{1275,7},
+{1274,11},{1114,12},{0,0},{0,0},{1223,8},{1162,6},{859,8},{398,3},
+{0,0},{1125,10},{1189,9},{0,0},{0,0},{0,0},{0,0},{1244,8},
+{78,4},{0,0},{0,0},{614,5},{767,10},{156,4},{32,3},{567,3},
+{1091,9},{878,6},{345,4},{619,5},{338,11},{232,4},{1164,6},{623,5},
+{0,0},{640,6},{1142,6},{143,5},{710,6},{0,0},{488,4},{1126,7},
+{426,3},{0,0},{207,4},{988,8},{652,7},{85,4},{0,0},{0,0},
+{226,7},{1224,8},{67,3},{448,5},{1108,5},{0,0},{0,0},{538,3},
+{0,0},{0,0},{418,5},{0,0},{1022,6},{777,5},{194,7},{786,5},
+{0,0},{0,0},{1325,6},{331,2},{0,0},{1352,8},{0,0},{600,6},
+{1161,6},{681,6},{675,5},{1210,5},{1194,8},{0,0},{0,0},{347,5},
+{1351,8},{534,7},{263,9},{887,6},{1094,7},{100,3},{115,4},{218,4},
+{648,7},{0,0},{0,0},{713,5},{0,0},{0,0},{1315,7},{0,0},
+{661,5},{0,0},{464,5},{6,2},{46,4},{673,4},{573,4},{0,0},
+{1327,6},{445,4},{1034,5},{642,5},{1337,7},{1237,6},{0,0},{0,0},
+{0,0},{1004,5},{1307,7},{0,0},{0,0},{0,0},{0,0},{1138,6},
+{132,4},{0,0},{199,4},{1080,8},{0,0},{140,5},{622,5},{691,6},
+{484,4},{0,0},{282,7},{0,0},{0,0},{1312,4},{18,3},{649,6},
+{314,4},{98,4},{768,10},{1283,7},{0,0},{281,8},{293,5},{0,0},
+{876,6},{986,5},{0,0},{0,0},{454,5},{0,0},{0,0},{0,0},
+{0,0},{0,0},{0,0},{0,0},{0,0},{892,8},{1174,7},{0,0},
+{0,0},{0,0},{731,4},{0,0},{725,5},{0,0},{361,5},{528,5},
+{1245,8},{0,0},{1150,6},{1103,8},{720,6},{0,0},{51,4},{0,0},
+{0,0},{1303,9},{591,4},{797,5},{833,8},{967,8},{138,5},{299,7},
+{0,0},{0,0},{272,5},{0,0},{60,3},{292,4},{741,5},{363,5},
+{0,0},{0,0},{206,5},{873,6},{266,6},{316,5},{1130,9},{736,6},
+{1166,6},{350,5},{653,7},{1308,7},{1324,6},{0,0},{0,0},{456,5},
+{0,0},{537,5},{960,7},{0,0},{236,10},{1191,9},{0,0},{773,5},
+{0,0},{209,4},{367,6},{610,5},{709,5},{823,8},{1099,6},{1062,6},
+{1201,7},{734,6},{1045,8},{80,4},{89,4},{0,0},{173,6},{0,0},
+{880,7},{864,8},{181,2},{0,0},{701,7},{479,5},{0,0},{0,0},
+{0,0},{0,0},{0,0},{1343,11},{0,0},{111,3},{0,0},{220,5},
+{547,5},{0,0},{525,5},{0,0},{580,4},{0,0},{901,7},{0,0},
+{0,0},{518,3},{0,0},{1052,7},{150,6},{0,0},{0,0},{1127,7},
+{558,4},{139,5},{0,0},{1239,6},{985,7},{1049,9},{0,0},{1272,7},
+{0,0},{312,4},{1344,10},{396,3},{735,6},{568,4},{38,3},{0,0},
+{0,0},{1128,8},{380,2},{510,3},{504,5},{0,0},{796,5},{0,0},
+{1001,6},{428,3},{551,3},{908,7},{0,0},{755,6},{439,4},{650,7},
+{0,0},{296,6},{0,0},{0,0},{740,7},{694,6},{637,6},{0,0},
+{1278,8},{0,0},{654,6},{11,2},{1298,9},{1084,5},{171,5},{0,0},
+{0,0},{1255,8},{0,0},{1302,9},{0,0},{1097,5},{447,4},{957,10},
+{302,9},{1037,5},{1178,9},{783,5},{1016,6},{0,0},{204,5},{989,8},
+{238,12},{152,5},{1183,9},{0,0},{0,0},{1148,6},{0,0},{944,5},
+{1131,10},{684,6},{577,7},{0,0},{849,8},{166,4},{0,0},{806,8},
+{599,5},{0,0},{0,0},{0,0},{613,5},{0,0},{0,0},{1077,8},
+{898,5},{0,0},{0,0},{910,7},{0,0},{0,0},{979,7},{651,8},
+{956,10},{1238,6},{164,7},{975,5},{1061,6},{187,4},{0,0},{0,0},
+{414,6},{0,0},{1261,8},{1123,9},{968,8},{1027,3},{0,0},{0,0},
+{0,0},{1172,5},{1195,5},{0,0},{1334,6},{954,9},{0,0},{1317,8},
+{909,7},{645,5},{945,6},{1282,7},{0,0},{310,4},{0,0},{1095,6},
+{265,8},{503,5},{421,7},{44,4},{1233,9},{0,0},{1360,8},{1181,10},
+{853,9},{443,3},{121,5},{743,4},{0,0},{515,3},{74,3},{288,6},
+{212,4},{244,4},{0,0},{0,0},{0,0},{0,0},{385,3},{322,7},
+{1043,7},{419,6},{0,0},{664,7},{0,0},{801,5},{408,4},{0,0},
+{0,0},{729,4},{0,0},{749,5},{721,5},{0,0},{1074,8},{48,4},
+{286,3},{563,5},{109,3},{0,0},{1358,7},{72,3},{1230,6},{0,0},
+{949,4},{0,0},{0,0},{323,6},{1171,7},{0,0},{717,4},{0,0},
+{303,10},{214,4},{0,0},{0,0},{0,0},{950,9},{59,3},{1102,8},
+{196,8},{0,0},{851,8},{0,0},{555,3},{0,0},{616,4},{0,0},
+{0,0},{0,0},{0,0},{875,6},{0,0},{883,7},{522,5},{0,0},
+{668,5},{1030,5},{1329,6},{375,2},{119,5},{1079,8},{0,0},{1011,5},
+{0,0},{0,0},{830,8},{308,5},{0,0},{0,0},{726,6},{0,0},
+{0,0},{128,5},{84,3},{451,4},{1040,6},{0,0},{655,4},{1208,7},
+{183,3},{560,5},{141,6},{0,0},{888,7},{1068,6},{0,0},{0,0},
+{596,5},{756,7},{344,6},{867,8},{1035,5},{1180,9},{556,3},{189,5},
+{539,4},{1285,7},{812,7},{43,4},{1059,10},{1086,7},{0,0},{871,6},
+{742,6},{492,3},{1214,8},{97,4},{144,6},{0,0},{526,3},{929,7},
+{0,0},{0,0},{0,0},{0,0},{1157,7},{818,7},{531,3},{129,5},
+{0,0},{1269,7},{666,5},{0,0},{269,4},{635,6},{0,0},{933,5},
+{1333,6},{497,3},{826,7},{942,5},{0,0},{0,0},{1140,6},{981,5},
+{0,0},{306,9},{145,5},{1033,5},{1153,6},{427,3},{1288,7},{996,6},
+{0,0},{1026,4},{540,2},{861,9},{110,3},{0,0},{87,4},{1071,8},
+{0,0},{252,6},{747,6},{1359,8},{631,6},{475,4},{0,0},{0,0},
+{390,3},{0,0},{1267,7},{841,6},{0,0},{978,7},{0,0},{0,0},
+};
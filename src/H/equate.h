@@ -33,5 +33,8 @@
 
 extern struct asym *CreateConstant( struct asm_tok[] );
 extern struct asym *CreateVariable( const char *, int );
+#if EQUTABLE
+extern bool        AddCompactConstant( struct asm_tok[] );
+#endif
 
 #endif
@@ -16,5 +16,8 @@ extern struct asym   *MakeExtern( const char *name, enum memtype type, struct as
 extern void        AddPublicData( struct asym *sym );
 //extern struct asym *GetPublicSymbols( void ** ); /* v2.11: obsolete */
 extern void        FreePubQueue( void );
+#if LAZYPROTO
+extern void        CompleteProto( struct asym * );
+#endif
 
 #endif
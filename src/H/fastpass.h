@@ -29,6 +29,12 @@ struct line_item {
     struct line_item *next;
     uint_32 lineno:20, srcfile:12;
     struct list_item *pList;
+#if TOKSTORE
+    struct tok_item *tokens; /* v2.21: tokens of the line, saved in pass 2 */
+#endif
+#if INVLINES
+    uint_8 invariant;        /* v2.21: line isn't replayed in pass 2+ */
+#endif
     char line[1];
 };
 
@@ -66,6 +72,20 @@ void SkipSavedState( void );
 struct line_item *RestoreState( void );
 void SaveVariableState( struct asym *sym );
 void FreeLineStore( void );
+#if TOKSTORE
+void StoreTokens( struct asm_tok *, int );
+int  LoadTokens( struct asm_tok * );
+#endif
+#if PCHSUPP
+struct line_item *GetLineStore( void );
+#endif
+#if INVLINES
+bool IsInvariantExpr( int, const struct asm_tok * );
+void InvLineMark( void );
+void InvLineEqu( struct asym * );
+void InvBlockStart( void );
+void InvBlockEnd( void );
+#endif
 
 struct list_item *ListGetItem( unsigned char bGeneratedCode );
 struct list_item *ListAddItem( char *pLine );
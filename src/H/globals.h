@@ -181,6 +181,73 @@ char *strupr(char *);
 #ifndef FASTMEM
 #define FASTMEM      1 /* fast memory allocation              */
 #endif
+#ifndef TOKSTORE
+#define TOKSTORE     FASTPASS /* v2.21: FASTPASS reuses tokens of stored lines */
+#endif
+#ifndef INVLINES
+#define INVLINES     FASTPASS /* v2.21: FASTPASS doesn't replay pass-invariant lines */
+#endif
+#ifndef EQUTABLE
+#define EQUTABLE     FASTPASS /* v2.21: numeric equates are stored in a compact table until used */
+#endif
+#ifndef SIMDSCAN
+#if defined(__GNUC__) && defined(__SSE2__)
+#define SIMDSCAN     1 /* v2.21: tokenizer scans 16/32 bytes at once */
+#else
+#define SIMDSCAN     0
+#endif
+#endif
+#ifndef SKIPSCAN
+#define SKIPSCAN     1 /* v2.21: inactive IF blocks skipped on raw source lines */
+#endif
+#ifndef FASTFLOAT
+#ifndef __I86__
+#define FASTFLOAT    1 /* v2.21: REAL4/REAL8 literals converted without strtod() */
+#else
+#define FASTFLOAT    0
+#endif
+#endif
+#ifndef PCHSUPP
+#if FASTPASS && FASTMEM && !defined(__I86__)
+#define PCHSUPP      1 /* v2.21: support -Fp ( saved state of -Fi files ) */
+#else
+#define PCHSUPP      0
+#endif
+#endif
+#ifndef FORKSUPP
+#if defined(__UNIX__)
+#define FORKSUPP     1 /* v2.21: support -jf ( fork modules after -Fi files ) */
+#else
+#define FORKSUPP     0
+#endif
+#endif
+#ifndef SERVERSUPP
+#if defined(__UNIX__)
+#define SERVERSUPP   1 /* v2.21: support -server and -client */
+#else
+#define SERVERSUPP   0
+#endif
+#endif
+#ifndef PREFETCH
+#if defined(__UNIX__) && defined(__GNUC__)
+#define PREFETCH     1 /* v2.21: support -Xr ( read-ahead thread ) */
+#else
+#define PREFETCH     0
+#endif
+#endif
+#ifndef OBJCACHE
+#if !defined(__I86__)
+#define OBJCACHE     1 /* v2.21: support -Fc ( object cache ) */
+#else
+#define OBJCACHE     0
+#endif
+#endif
+#ifndef STRUCTINDEX
+#define STRUCTINDEX  1 /* v2.21: member names of STRUCT/UNION types are indexed */
+#endif
+#ifndef LAZYPROTO
+#define LAZYPROTO    1 /* v2.21: PROTOs are parsed when the name is used first */
+#endif
 
 #include "inttype.h"
 #include "bool.h"
@@ -471,6 +538,12 @@ enum opt_names {
     OPTN_ERR_FN,              /* -Fr option */
 #if DLLIMPORT
     OPTN_LNKDEF_FN,           /* -Fd option */
+#endif
+#if PCHSUPP
+    OPTN_PCH_FN,              /* -Fp option */
+#endif
+#if OBJCACHE
+    OPTN_CACHE_DIR,           /* -Fc option */
 #endif
     OPTN_MODULE_NAME,         /* -nm option */
     OPTN_TEXT_SEG,            /* -nt option */
@@ -586,7 +659,6 @@ struct global_options {
     bool        dump_reswords;           /* -dr option */
     bool        dump_reswords_hash;      /* -drh option */
     bool        dump_symbols;            /* -ds option */
-    bool        dump_symbols_hash;       /* -dsh option */
     bool        display_memalloc;        /* -dma option */
 #endif
     char        *names[OPTN_LAST];
@@ -629,6 +701,18 @@ struct global_options {
     bool        all_symbols_public;      /* -Zf option  */
     bool        safeseh;                 /* -safeseh option */
     uint_8      ignore_include;          /* -X option */
+    bool        dump_symbols_hash;       /* -dsh option; v2.21: also in release version */
+#if OBJCACHE
+    bool        print_cache_stats;       /* -Fcs option; v2.21 */
+#endif
+#if defined(__UNIX__)
+    bool        cache_incdirs;           /* -Xc option; v2.21 */
+    unsigned    jobs;                    /* -j option; v2.21 */
+    bool        fork_modules;            /* -jf option; v2.21 */
+#endif
+#if PREFETCH
+    bool        read_ahead;              /* -Xr option; v2.21 */
+#endif
     enum oformat output_format;          /* -bin, -omf, -coff, -elf options */
     enum sformat sub_format;             /* -mz, -pe, -win64, -elf64 options */
     uint_8      fieldalign;              /* -Zp option  */
@@ -678,6 +762,7 @@ struct fixup;
 
 struct fname_item {
     char    *fname;
+    char    *guard; /* v2.21: multiple-include guard symbol, see input.c */
     //char    *fullname; /* v2.11: removed */
     //time_t  mtime; /* v2.11: removed */
 #ifdef DEBUG_OUT
@@ -896,6 +981,12 @@ extern int              AssembleModule( const char * );
 extern void             AddLinnumDataRef( unsigned, uint_32 );
 extern void             SetMasm510( bool );
 extern void             close_files( void );
+extern FILE             *ExtFile[NUM_FILE_TYPES];
+#if FORKSUPP
+extern bool             (*ForkModules)( void );
+extern void             RetargetModule( const char * );
+extern void             AbandonModule( void );
+#endif
 extern char             *myltoa( uint_32 value, char *buffer, unsigned radix, bool sign, bool addzero );
 #if COFF_SUPPORT || PE_SUPPORT
 extern char             *ConvertSectionName( const struct asym *, enum seg_type *pst, char *buffer );
@@ -68,7 +68,20 @@ extern const char *GetFNamePart( const char *fname );
 extern char     *GetExtPart( const char *fname );
 
 extern FILE     *SearchFile( const char *path, bool );
+#if PCHSUPP
+extern unsigned AddFileName( const char *, char * );
+#endif
+#if FORKSUPP
+extern bool     FileHasWord( const char *, const char * );
+extern void     SetMainSrcFile( void );
+#endif
 extern char     *GetTextLine( char *buffer );
+#if SKIPSCAN
+extern void     SkipFalseLines( void );
+#endif
+#if PREFETCH
+extern void     InputPrefetch( struct qitem * );
+#endif
 extern void     PushMacro( struct macro_instance * );
 extern void     SetLineNumber( unsigned );
 #if FASTMEM==0
@@ -78,6 +91,8 @@ extern void     AddStringToIncludePath( const char *string );
 extern void     InputInit( void );
 extern void     InputPassInit( void );
 extern void     InputFini( void );
+extern void     InputCacheFini( void );
+extern void     InputPathCacheFini( void );
 extern struct asm_tok *PushInputStatus( struct input_status * );
 extern void     PopInputStatus( struct input_status * );
 extern int      GetCurrSrcPos( char * );
@@ -0,0 +1,46 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  interface of libjwasm.so ( see jwlib.c )
+*
+****************************************************************************/
+
+#ifndef _JWLIB_H_INCLUDED
+#define _JWLIB_H_INCLUDED
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define JWLIBAPI __attribute__ ((visibility("default")))
+#else
+#define JWLIBAPI
+#endif
+
+/* return codes of JWasmAssemble() */
+
+#define JWLIB_OK       0 /* no errors */
+#define JWLIB_ERRORS   1 /* errors occured, see messages */
+#define JWLIB_OVERFLOW 2 /* output buffer too small, *outsize is the size needed */
+#define JWLIB_FAILURE  3 /* invalid options or out of memory */
+
+/* assemble a source held in memory.
+ * options: cmdline options, separated by white space; no file names.
+ * name:    name of the source, used for the module name and @FileName;
+ *          included files are searched relative to it. May be NULL.
+ * src:     source text of size srcsize.
+ * out:     buffer for the object module/binary; *outsize is its size on
+ *          entry, and the size of the module on exit.
+ * msgs:    buffer for errors and warnings; *msgsize is its size on entry,
+ *          and the size of the text on exit. The text is truncated if the
+ *          buffer is too small; it's always terminated by a 00 byte.
+ * Calls are serialized, the library may be used by multiple threads.
+ */
+JWLIBAPI int JWasmAssemble( const char *options, const char *name,
+                           const char *src, size_t srcsize,
+                           void *out, size_t *outsize,
+                           char *msgs, size_t *msgsize );
+
+#endif
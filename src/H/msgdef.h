@@ -26,7 +26,7 @@ pick( TXT_ALIASNAME,          "alias" ) /* v2.10: added */
 /* error/warning message text constants */
 
 pick( MSG_USAGE2,             "Run \"JWasm -?\" or \"JWasm -h\" for more info\n" )
-pick( msg_unused3,          "" )
+pick( MSG_CACHE_STATS,        "Object cache %s: %u hits, %u misses, %u not cacheable\n" )
 pick( msg_unused4,          "" )
 pick( msg_unused5,          "" )
 pick( msg_unused6,          "" )
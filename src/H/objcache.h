@@ -0,0 +1,25 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  prototypes of functions in objcache.c
+*
+****************************************************************************/
+
+#ifndef _OBJCACHE_H_INCLUDED
+#define _OBJCACHE_H_INCLUDED
+
+#if OBJCACHE
+
+extern bool     ObjCacheLookup( void );
+extern void     ObjCacheAddFile( const char * );
+extern void     ObjCacheEcho( const char *, bool );
+extern void     ObjCacheCollect( unsigned, unsigned );
+extern void     ObjCacheStore( void );
+extern void     ObjCachePrintStats( void );
+
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  prototypes of functions in pch.c
+*
+****************************************************************************/
+
+#ifndef _PCH_H_INCLUDED
+#define _PCH_H_INCLUDED
+
+#if PCHSUPP
+
+extern bool     PchLoad( void );
+extern void     PchBegin( void );
+extern void     PchWrite( void );
+extern void     PchSaveState( void );
+extern void     PchPassInit( void );
+extern void     PchEcho( const char * );
+extern void     PchFini( void );
+
+#endif
+
+#endif
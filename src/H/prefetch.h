@@ -0,0 +1,24 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  prototypes of functions in prefetch.c
+*
+****************************************************************************/
+
+#ifndef _PREFETCH_H_INCLUDED
+#define _PREFETCH_H_INCLUDED
+
+#if PREFETCH
+
+struct stat;
+
+extern void     PrefetchFile( const char *, unsigned, bool );
+extern char     *PrefetchGet( const char *, const struct stat *, size_t * );
+extern void     PrefetchFini( void );
+
+#endif
+
+#endif
@@ -42,6 +42,8 @@ enum reservedword_flags {
 #if AVXSUPP
     RWF_VEX      = 8, /* keyword triggers VEX encoding */
 #endif
+    RWF_STATIC   = 0x10, /* v2.21: keyword is in the static hash table */
+    RWF_HIDDEN   = 0x20, /* v2.21: static entry is currently invalid */
 };
 
 /* structure of items in the "reserved names" table ResWordTable[] */
@@ -57,13 +59,21 @@ struct ReservedWord {
 #endif
 };
 
+extern uint_32  GetNameHash( const char *, unsigned );
 extern unsigned FindResWord( const char *, unsigned char );
+extern unsigned FindResWordHash( const char *, unsigned char, uint_32 );
 extern char     *GetResWName( unsigned, char * );
 extern bool     IsKeywordDisabled( const char *, int );
 extern void     DisableKeyword( unsigned );
 #if RENAMEKEY
 extern void     RenameKeyword( unsigned, const char *, uint_8 );
 #endif
+#if PCHSUPP
+extern unsigned GetDisabledKeyword( unsigned );
+#if RENAMEKEY
+extern unsigned GetRenamedKeyword( void ** );
+#endif
+#endif
 #if AMD64_SUPPORT
 extern void     Set64Bit( bool );
 #endif
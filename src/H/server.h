@@ -0,0 +1,23 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  prototypes of functions in server.c
+*
+****************************************************************************/
+
+#ifndef _SERVER_H_INCLUDED
+#define _SERVER_H_INCLUDED
+
+#if SERVERSUPP
+
+extern int      RunServer( const char *, int (*)( char ** ) );
+extern int      RunClient( const char *, char ** );
+extern void     ServerExit( int );
+extern int      GuardedJob( int (*)( char ** ), char ** );
+
+#endif
+
+#endif
@@ -116,10 +116,31 @@ struct debug_info {
     unsigned next_file;  /* index next file */
 };
 
+/* v2.21: the fields used by the symbol table searches ( nextitem, name,
+ * hashval, name_size ) are located at the start of the structure, so a
+ * search touches one cache line per symbol. state, mem_type and langtype
+ * are stored in bytes.
+ */
+
 struct asym {
     /* v2.11: name changed from 'next' to 'nextitem' */
     struct asym     *nextitem;     /* next symbol in hash line */
     char            *name;         /* symbol name */
+    uint_32         hashval;      /* v2.21: hash of name ( see GetNameHash() ) */
+#if (MAX_ID_LEN <= 255)
+    uint_8          name_size;
+#else
+    uint_16         name_size;
+#endif
+#ifdef __WATCOMC__
+    enum sym_state  state;
+    enum memtype    mem_type;
+    enum lang_type  langtype;
+#else
+    uint_8          state;        /* enum sym_state */
+    uint_8          mem_type;     /* enum memtype */
+    uint_8          langtype;     /* enum lang_type */
+#endif
     union {
         int_32         offset;     /* used by SYM_INTERNAL (labels), SYM_TYPE, SYM_STACK, v2.11: SYM_SEG */
         int_32         value;      /* used by SYM_INTERNAL (equates) */
@@ -132,8 +153,6 @@ struct asym {
         int_32         class_lname_idx;/* used by SYM_CLASS_LNAME */
     };
     struct asym     *segment;      /* used by SYM_INTERNAL, SYM_EXTERNAL */
-    enum sym_state  state;
-    enum memtype    mem_type;
     unsigned char   referenced:1,  /* symbol has been referenced */
                     isdefined:1,  /* symbol is "defined" in this pass */
                     scoped:1,     /* symbol is local label or SYM_STACK */
@@ -159,6 +178,9 @@ struct asym {
                     fwdref:1,     /* symbol was forward referenced */
                     isexport:1,   /* v2.19: symbol exported ( SYM_INTERNAL ) */
                     included:1;   /* COFF: static symbol added to public queue. ELF:symbol added to symbol table (SYM_INTERNAL) */
+#if LAZYPROTO
+    unsigned char   isdeferred:1; /* v2.21: SYM_EXTERNAL: PROTO not parsed yet ( see extern.c ) */
+#endif
     union {
         /* for SYM_INTERNAL (data labels, memtype != NEAR|FAR|EMPTY), SYM_STRUCT_FIELD */
         uint_32         first_size;   /* size of 1st initializer's dimension in bytes */
@@ -183,6 +205,9 @@ struct asym {
             unsigned char   isfar:1;   /* SYM_EXTERNAL, SYM_TYPE, SYM_STACK */
             unsigned char   is_vararg:1;/* SYM_STACK, VARARG param */
             unsigned char   is_signed:1;/* v2.21: SYM_INTERNAL (mem_type EMPTY) */
+#if INVLINES
+            unsigned char   is_fixed:1; /* v2.21: SYM_INTERNAL (mem_type EMPTY): value known in pass one */
+#endif
             //unsigned char   is_type:1;  /* v2.21: added SYM_INTERNAL (mem_type EMPTY) - not active */
         };
         /* for SYM_MACRO */
@@ -238,12 +263,6 @@ struct asym {
             uint_8         typekind;
         };
     };
-#if (MAX_ID_LEN <= 255)
-    uint_8          name_size;
-#else
-    uint_16         name_size;
-#endif
-    enum lang_type  langtype;
 #ifdef DEBUG_OUT
     union {
         struct asym *type;        /* set if memtype is MT_TYPE */
@@ -351,11 +370,14 @@ struct seg_info {
 
 /* PROC item */
 
+/* size of a PROC's local hash table */
+#define LHASH_TABLE_SIZE 127
+
 struct proc_info {
     uint_16             *regslist;      /* PROC: list of registers to be saved */
     struct dsym         *paralist;      /* list of parameters */
     struct dsym         *locallist;     /* PROC: list of local variables */
-    struct dsym         *labellist;     /* PROC: list of local labels */
+    struct asym         **localtab;     /* PROC: v2.21: local hash table ( params, locals, labels ), NULL if empty */
     unsigned            parasize;       /* total no. of bytes used by parameters */
     unsigned            localsize;      /* PROC: total no. of bytes used by local variables */
     char                *prologuearg;   /* PROC: prologuearg attribute */
@@ -436,9 +458,29 @@ enum type_kind {
     TYPE_RECORD
 };
 
+#if STRUCTINDEX
+/* v2.21: hash table of the member names of a STRUCT/UNION, built when
+ * the type is closed. Members of anonymous members are included,
+ * <offset> is the sum of the offsets of the anonymous members.
+ */
+struct mbr_item {
+    struct asym         *sym;   /* NULL if the slot is free */
+    uint_32             hash;
+    uint_32             offset;
+};
+
+struct mbr_index {
+    unsigned            mask;   /* number of slots - 1 */
+    struct mbr_item     items[1];
+};
+#endif
+
 struct struct_info {
     struct sfield       *head; /* STRUCT/UNION/RECORD: start of field list */
     struct sfield       *tail; /* STRUCT/UNION/RECORD: current/next field */
+#if STRUCTINDEX
+    struct mbr_index    *index; /* STRUCT/UNION: v2.21: name index, NULL if none */
+#endif
     /* v2.08: typekind moved to struct asym */
     //#ifdef __WATCOMC__
     //    enum type_kind      typekind;
@@ -452,6 +494,9 @@ struct struct_info {
             unsigned char   isInline:1;  /* STRUCT/UNION: inline (unused) */
             unsigned char   isOpen:1;    /* STRUCT/UNION: set until the matching ENDS is found */
             unsigned char   OrgInside:1; /* STRUCT: struct contains an ORG */
+#if STRUCTINDEX
+            unsigned char   isIndexed:1; /* STRUCT/UNION: v2.21: BuildIndex() has been called */
+#endif
         };
     };
 };
@@ -469,9 +514,12 @@ struct dsym {
         struct proc_info    *procinfo;  /* SYM_INTERNAL|SYM_EXTERNAL (procs, isproc=1) */
         struct struct_info  *structinfo;/* SYM_TYPE (structs, unions, records [, typedefs]) */
         struct macro_info   *macroinfo; /* SYM_MACRO (macros) */
+#if LAZYPROTO
+        struct lazy_proto   *lazyinfo;  /* SYM_EXTERNAL, isdeferred=1 ( v2.21 ) */
+#endif
         /* SYM_STACK, SYM_INTERNAL (code labels, isproc=0)
-         * used to save the local hash table (contains PROC locals: params,
-         * locals, labels). Details see SymGetLocal(), SymSetLocal() in symbols.c
+         * v2.21: unused; previously used to save the local hash table.
+         * Each PROC has its own table now, see SymSetLocal() in symbols.c
          */
         struct dsym *nextll;
     } e;
@@ -517,6 +565,10 @@ extern  struct asym     *SymLookupLocal( const char * );
 
 extern  struct asym     *SymFind( const char *name );
 #define SymSearch(x) SymFind(x)
+extern  struct asym     *SymFindHash( const char *, int, uint_32 );
+extern  struct asym     *SymSearchTok( const struct asm_tok * );
+extern  struct asym     *SymPeekTok( const struct asm_tok * );
+extern  struct asym     *SymLookupTok( const struct asm_tok * );
 
 extern  void            SymInit( void );
 extern  void            SymFini( void );
@@ -525,6 +577,10 @@ extern  void            SymMakeAllSymbolsPublic( void );
 extern  void            SymGetAll( struct asym ** );
 extern  struct asym     *SymEnum( struct asym *, int * );
 extern  uint_32         SymGetCount( void );
+#if EQUTABLE
+extern  bool            SymAddEquate( const struct asm_tok *, uint_64 );
+#endif
+extern  void            SymCompleteAll( void );
 
 #if defined(__WATCOMC__)
 typedef int (__watcall * StrCmpFunc)(const void *, const void *, size_t );
@@ -536,6 +592,5 @@ extern StrCmpFunc SymCmpFunc;
 extern  void            SymSetCmpFunc( void );
 extern  void            SymClearLocal( void );
 extern  void            SymSetLocal( struct asym * );
-extern  void            SymGetLocal( struct asym * );
 
 #endif
@@ -80,11 +80,12 @@ struct asm_tok {
         char numbase;             /* T_NUM: number base */
         char specval;             /* 1-byte special tokens: flags */
     };
+    uint_32 hashval;              /* T_ID: v2.21: hash of name, valid if idlen != 0 */
     char *string_ptr;
     union {
         unsigned int tokval;      /* index if token is a reserved word */
         unsigned int stringlen;   /* T_STRING: size */
-        unsigned int idarg;       /* T_ID: currently not used */
+        unsigned int idlen;       /* T_ID: v2.21: size of name, 0 if hashval isn't set */
         unsigned int itemlen;     /* T_NUM: size */
         unsigned int lastidx;     /* T_FINAL: last index (used in RunMacro()) */
     };
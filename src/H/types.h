@@ -19,6 +19,7 @@ extern struct dsym *CurrStruct; /* start of current STRUCT list */
 
 extern struct asym *CreateTypeSymbol( struct asym *, const char *, bool );
 extern struct asym *SearchNameInStruct( const struct asym *, const char *, uint_32 *, int level );
+extern struct asym *SearchTokInStruct( const struct asym *, const struct asm_tok *, uint_32 * );
 //extern ret_code    EndstructDirective( int );
 extern ret_code    GetQualifiedType( int *, struct asm_tok[], struct qualified_type * );
 extern struct asym *CreateStructField( int, struct asm_tok[], const char *, enum memtype, struct asym *, uint_32 );
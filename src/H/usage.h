@@ -11,16 +11,27 @@
 #endif
 "-c\0"              "Assemble without linking (always set)\0"
 "-C{p|u|x}\0"       "Set OPTION CASEMAP: p=NONE, u=ALL, x=NOTPUBLIC (default)\0"
+#if SERVERSUPP
+"-client <socket>\0" "Let a server assemble the modules (first option)\0"
+#endif
 "-D<name>[=text]\0" "Define text macro\0"
+"-dsh\0"            "Display global symbols hash table statistics\0"
 "-e<number>\0"      "Set error limit number (default=50)\0"
 "-EP\0"             "Output preprocessed listing to stdout\0"
 "-eq\0"             "don't display error messages\0"
+#if OBJCACHE
+"-Fc<directory>\0"  "Use object cache in <directory>\0"
+"-Fcs\0"            "Display object cache statistics\0"
+#endif
 #if DLLIMPORT
 "-Fd[=<file_name>]\0"  "Write import definition file\0"
 #endif
 "-Fi<file_name>\0"  "Force <file_name> to be included\0"
 "-Fl[=<file_name>]\0" "Write listing file\0"
 "-Fo<file_name>\0"  "Set object file name\0"
+#if PCHSUPP
+"-Fp<file_name>\0"  "Use/write saved state of -Fi files\0"
+#endif
 "-Fw<file_name>\0"  "Set errors file name\0"
 "-FPi\0"            "80x87 instructions with emulation fixups\0"
 "-FPi87\0"          "80x87 instructions (default)\0"
@@ -28,6 +39,10 @@
 "-fp<n>\0"          "Set FPU, <n> is: 0=8087 (default), 2=80287, 3=80387\0"
 "-G{c|d|r|z}\0"     "Use Pascal, C, Fastcall or Stdcall calling convention\0"
 "-I<directory>\0"   "Add directory to list of include directories\0"
+#if defined(__UNIX__)
+"-j<number>\0"      "Assemble up to <number> modules in parallel\0"
+"-jf\0"             "Process -Fi files once, then fork for each module\0"
+#endif
 "-m{t|s|c|m|l|h|f}\0" "Set memory model:\0"
 "\0"                "(Tiny, Small, Compact, Medium, Large, Huge, Flat)\0"
 "-nc=<name>\0"       "Set class name of code segment\0"
@@ -44,6 +59,9 @@
 #if COFF_SUPPORT
 "-safeseh\0"        "Assert all exception handlers are declared\0"
 #endif
+#if SERVERSUPP
+"-server <socket>\0" "Run as server, wait for jobs at <socket> (only option)\0"
+#endif
 "-Sf\0"             "Generate first pass listing\0"
 "-Sg\0"             "Display generated code in listing\0"
 "-Sn\0"             "Suppress symbol-table listing\0"
@@ -55,6 +73,12 @@
 "-W{0|..|4}\0"      "Set warning level (default 2)\0"
 "-WX\0"             "Treat all warnings as errors\0"
 "-X\0"              "Ignore INCLUDE environment path\0"
+#if defined(__UNIX__)
+"-Xc\0"             "Cache contents of include directories\0"
+#endif
+#if PREFETCH
+"-Xr\0"             "Read source files ahead in a thread\0"
+#endif
 "-zcm\0"            "C names are decorated with '_' prefix (default)\0"
 "-zcw\0"            "No name decoration for C symbols\0"
 "-Zd\0"             "Add line number debug info (OMF, COFF, ELF)\0"
@@ -122,7 +146,6 @@
 "-dr\0"             "Display reserved words\0"
 "-drh\0"            "Display reserved words hash table\0"
 "-ds\0"             "Display global symbols\0"
-"-dsh\0"            "Display global symbols hash table\0"
 "-dt\0"             "Display debug trace\0"
 #if FASTPASS
 "-ls\0"             "Display preprocessed line storage\0"
@@ -37,6 +37,9 @@
 #include "linnum.h"
 #include "cpumodel.h"
 #include "lqueue.h"
+#include "pch.h"
+#include "objcache.h"
+#include "prefetch.h"
 #if DLLIMPORT
 #include "mangle.h"
 #endif
@@ -85,6 +88,26 @@ extern const char       *ModelToken[];
 extern void             FreeLibQueue();
 #endif
 
+#if FORKSUPP
+/* v2.21: -jf: called in pass one after the -Fi files; set by main.c.
+ * returns TRUE if the workers have been created.
+ */
+bool                    (*ForkModules)( void );
+#endif
+
+/* v2.21: source, object and error file supplied by the caller ( see jwlib.c ).
+ * These files are used instead of the named ones; they are neither closed
+ * nor deleted by the assembler.
+ */
+FILE                    *ExtFile[NUM_FILE_TYPES];
+
+static clock_t          starttime; /* v2.21: global, see OnePass() */
+
+#if INVLINES && defined(DEBUG_OUT)
+static uint_32          cntreplayed; /* v2.21: stored lines replayed in passes 2+ */
+static uint_32          cntinvlines; /* v2.21: pass-invariant lines not replayed */
+#endif
+
 /* parameters for output formats. order must match enum oformat */
 static const struct format_options formatoptions[] = {
 #if BIN_SUPPORT
@@ -963,6 +986,39 @@ static void PassOneChecks( void )
     return;
 }
 
+#if FORKSUPP
+
+/* v2.21: -jf: may the state after the -Fi files be used for other modules?
+ * Nothing that depends on the main source's name must have been used:
+ * @FileName and the code segment name of the far code models.
+ * The directory of the main source is checked by the caller.
+ */
+static bool IsForkable( void )
+/****************************/
+{
+    unsigned i;
+
+    if ( ModuleInfo.g.error_count || ModuleInfo.g.warning_count ||
+        CurrFile[ERR] || Options.write_listing )
+        return( FALSE );
+#if OBJCACHE
+    /* the object cache is checked for each source before pass one */
+    if ( Options.names[OPTN_CACHE_DIR] )
+        return( FALSE );
+#endif
+    if ( ModuleInfo.model != MODEL_NONE && ( SIZE_CODEPTR & ( 1 << ModuleInfo.model ) ) &&
+        Options.names[OPTN_TEXT_SEG] == NULL )
+        return( FALSE );
+    for ( i = 0; i < ModuleInfo.g.cnt_fnames; i++ )
+        if ( i != ModuleInfo.srcfile && FileHasWord( GetFName( i )->fname, "@FileName" ) ) {
+            DebugMsg(("IsForkable: @FileName used in %s\n", GetFName( i )->fname ));
+            return( FALSE );
+        }
+    return( TRUE );
+}
+
+#endif
+
 /* do ONE assembly pass
  * the FASTPASS variant (which is default now) doesn't scan the full source
  * for each pass. For this to work, the following things are implemented:
@@ -1017,7 +1073,19 @@ static int OnePass( void )
     //if ( Parse_Pass > PASS_1 && UseSavedState == TRUE ) {
     if ( UseSavedState ) {
         LineStoreCurr = RestoreState();
+#if PCHSUPP
+        PchPassInit();
+#endif
         while ( LineStoreCurr && ModuleInfo.EndDirFound == FALSE ) {
+#if INVLINES
+            /* v2.21: pass-invariant lines are skipped, their effect is kept from pass one */
+            if ( LineStoreCurr->invariant ) {
+                DebugCmd( cntinvlines++ );
+                LineStoreCurr = LineStoreCurr->next;
+                continue;
+            }
+            DebugCmd( cntreplayed++ );
+#endif
             /* the source line is modified in Tokenize() if it contains a comment! */
  #if USELSLINE==0
             strcpy( CurrSource, LineStoreCurr->line );
@@ -1030,11 +1098,23 @@ static int OnePass( void )
                 Parse_Pass+1, LineStoreCurr, LineStoreCurr->next, LineStoreCurr->srcfile, GetTopSrcName(),
                 LineStoreCurr->lineno, MacroLevel, LineStoreCurr->line ));
             ModuleInfo.CurrComment = NULL; /* v2.08: added (var is never reset because GetTextLine() isn't called) */
+ #if TOKSTORE
+            /* v2.21: the tokens of pass two are reused */
+            if ( LineStoreCurr->tokens )
+                Token_Count = LoadTokens( ModuleInfo.tokenarray );
+            else {
+ #endif
  #if USELSLINE
-            if ( Token_Count = Tokenize( LineStoreCurr->line, 0, ModuleInfo.tokenarray, TOK_DEFAULT ) )
+            Token_Count = Tokenize( LineStoreCurr->line, 0, ModuleInfo.tokenarray, TOK_DEFAULT );
  #else
-            if ( Token_Count = Tokenize( CurrSource, 0, ModuleInfo.tokenarray, TOK_DEFAULT ) )
+            Token_Count = Tokenize( CurrSource, 0, ModuleInfo.tokenarray, TOK_DEFAULT );
+ #endif
+ #if TOKSTORE
+                if ( Parse_Pass == PASS_2 && Token_Count )
+                    StoreTokens( ModuleInfo.tokenarray, Token_Count );
+            }
  #endif
+            if ( Token_Count )
                 ParseLine( ModuleInfo.tokenarray );
             LineStoreCurr = LineStoreCurr->next;
         }
@@ -1043,11 +1123,38 @@ static int OnePass( void )
     {
         struct qitem *pq;
         /* v2.11: handle -Fi files here ( previously in CmdlParamsInit ) */
-        for ( pq = Options.queues[OPTQ_FINCLUDE]; pq; pq = pq->next ) {
+        pq = Options.queues[OPTQ_FINCLUDE];
+#if PCHSUPP
+        /* v2.21: -Fp: load the state after the -Fi files or prepare to save it */
+        if ( Parse_Pass == PASS_1 ) {
+            if ( PchLoad() )
+                pq = NULL;
+            else
+                PchBegin();
+        }
+#endif
+#if PREFETCH
+        /* v2.21: -Xr: start to read the -Fi files and the includes of the main source */
+        if ( Parse_Pass == PASS_1 && Options.read_ahead )
+            InputPrefetch( pq );
+#endif
+        for ( ; pq; pq = pq->next ) {
             DebugMsg(("OnePass: force include of file: %s\n", pq->value ));
             if ( SearchFile( pq->value, TRUE ) )
                 ProcessFile( ModuleInfo.tokenarray );
         }
+#if PCHSUPP
+        if ( Parse_Pass == PASS_1 )
+            PchWrite();
+#endif
+#if FORKSUPP
+        /* v2.21: -jf: the workers continue from here, the template stops */
+        if ( Parse_Pass == PASS_1 && ForkModules && IsForkable() ) {
+            if ( ForkModules() )
+                longjmp( jmpenv, 1 );
+            starttime = clock(); /* the CPU time of a worker starts with 0 */
+        }
+#endif
         ProcessFile( ModuleInfo.tokenarray ); /* process the main source file */
     }
 
@@ -1182,7 +1289,10 @@ static void open_files( void )
 
     //memset( CurrFile, 0, sizeof( CurrFile ) );
     /* CurrFile[ASM] = fopen( CurrFName[ASM], "r" ); */
-    CurrFile[ASM] = fopen( CurrFName[ASM], "rb" );
+    if ( ExtFile[ASM] )
+        CurrFile[ASM] = ExtFile[ASM];
+    else
+        CurrFile[ASM] = fopen( CurrFName[ASM], "rb" );
     if( CurrFile[ASM] == NULL ) {
         DebugMsg(("open_files(): cannot open source file, fopen(\"%s\") failed\n", CurrFName[ASM] ));
         Fatal( CANNOT_OPEN_FILE, CurrFName[ASM], ErrnoStr() );
@@ -1190,7 +1300,10 @@ static void open_files( void )
 
     /* open OBJ file */
     if ( Options.syntax_check_only == FALSE ) {
-        CurrFile[OBJ] = fopen( CurrFName[OBJ], "wb" );
+        if ( ExtFile[OBJ] )
+            CurrFile[OBJ] = ExtFile[OBJ];
+        else
+            CurrFile[OBJ] = fopen( CurrFName[OBJ], "wb" );
         if( CurrFile[OBJ] == NULL ) {
             DebugMsg(("open_files(): cannot open object file, fopen(\"%s\") failed\n", CurrFName[OBJ] ));
             Fatal( CANNOT_OPEN_FILE, CurrFName[OBJ], ErrnoStr() );
@@ -1206,6 +1319,19 @@ static void open_files( void )
     return;
 }
 
+/* v2.21: files supplied by the caller are just flushed */
+
+static int CloseFile( int type )
+/******************************/
+{
+    FILE *file = CurrFile[type];
+
+    CurrFile[type] = NULL;
+    if ( file == ExtFile[type] )
+        return( fflush( file ) );
+    return( fclose( file ) );
+}
+
 void close_files( void )
 /**********************/
 {
@@ -1216,20 +1342,18 @@ void close_files( void )
 
     /* close ASM file */
     if( CurrFile[ASM] != NULL ) {
-        if( fclose( CurrFile[ASM] ) != 0 )
+        if( CloseFile( ASM ) != 0 )
             EmitErr( CANNOT_CLOSE_FILE, CurrFName[ASM], errno );
-        CurrFile[ASM] = NULL;
     }
 
     /* close OBJ file */
     if ( CurrFile[OBJ] != NULL ) {
-        if ( fclose( CurrFile[OBJ] ) != 0 )
+        if ( CloseFile( OBJ ) != 0 )
             EmitErr( CANNOT_CLOSE_FILE, CurrFName[OBJ], errno );
-        CurrFile[OBJ] = NULL;
     }
     /* delete the object module if errors occured */
     if ( Options.syntax_check_only == FALSE &&
-        ModuleInfo.g.error_count > 0 ) {
+        ModuleInfo.g.error_count > 0 && ExtFile[OBJ] == NULL ) {
         remove( CurrFName[OBJ] );
     }
 
@@ -1240,9 +1364,8 @@ void close_files( void )
 
     /* close ERR file */
     if ( CurrFile[ERR] != NULL ) {
-        fclose( CurrFile[ERR] );
-        CurrFile[ERR] = NULL;
-    } else if ( CurrFName[ERR] )
+        CloseFile( ERR );
+    } else if ( CurrFName[ERR] && ExtFile[ERR] == NULL )
         /* nothing written, delete any existing ERR file */
         remove( CurrFName[ERR] );
     return;
@@ -1347,9 +1470,18 @@ static void AssembleInit( const char *source )
     ModuleInfo.g.LinnumQueue.head = NULL;
 
     SetFilenames( source );
+#if PREFETCH
+    /* v2.21: -Xr: the main source is read while the tables are initialized */
+    if ( ExtFile[ASM] == NULL )
+        PrefetchFile( CurrFName[ASM], strlen( CurrFName[ASM] ) + 1, FALSE );
+#endif
 
 #if FASTPASS
     FastpassInit();
+#endif
+#if INVLINES && defined(DEBUG_OUT)
+    cntreplayed = 0;
+    cntinvlines = 0;
 #endif
     open_files();
 #if BUILD_TARGET
@@ -1367,6 +1499,47 @@ static void AssembleInit( const char *source )
     return;
 }
 
+#if FORKSUPP
+
+/* v2.21: -jf: a worker forked after the -Fi files continues with
+ * another source; the main source hasn't been read yet.
+ * The files of the template are just closed; they belong to its worker.
+ */
+void RetargetModule( const char *source )
+/***************************************/
+{
+    int i;
+
+    DebugMsg(("RetargetModule(\"%s\") enter\n", source ));
+    for ( i = 0; i < NUM_FILE_TYPES; i++ ) {
+        if ( CurrFile[i] ) {
+            fclose( CurrFile[i] );
+            CurrFile[i] = NULL;
+        }
+        LclFree( CurrFName[i] );
+        CurrFName[i] = NULL;
+    }
+    SetFilenames( source );
+    open_files();
+    get_module_name();
+    SetMainSrcFile();
+    return;
+}
+
+/* v2.21: -jf: the template has created a worker for its source.
+ * the ERR file belongs to the worker now; it must neither be
+ * written nor deleted by the template.
+ */
+void AbandonModule( void )
+/************************/
+{
+    DebugMsg(("AbandonModule(\"%s\")\n", CurrFName[ASM] ));
+    LclFree( CurrFName[ERR] );
+    CurrFName[ERR] = NULL;
+}
+
+#endif
+
 #ifdef DEBUG_OUT
 void DumpInstrStats( void );
 #endif
@@ -1384,6 +1557,10 @@ static void AssembleFini( void )
     DumpInstrStats();
     MacroFini();
     LstFini();
+#if INVLINES
+    if ( Options.quiet == FALSE )
+        printf("stored lines replayed/skipped as pass-invariant: %" I32_SPEC "u / %" I32_SPEC "u\n", cntreplayed, cntinvlines );
+#endif
 #endif
     FreePubQueue();
 #if FASTMEM==0
@@ -1393,6 +1570,9 @@ static void AssembleFini( void )
 #endif
     InputFini();
     close_files();
+#if OBJCACHE
+    ObjCacheStore();
+#endif
 
 #if FASTPASS
 #if FASTMEM==0
@@ -1406,6 +1586,9 @@ static void AssembleFini( void )
         CurrFName[i] = NULL;
     }
     MemFini();
+#if PCHSUPP
+    PchFini();
+#endif
     return;
 }
 
@@ -1424,7 +1607,6 @@ int EXPQUAL AssembleModule( const char *source )
 {
     uint_32       prev_written = -1;
     uint_32       curr_written;
-    clock_t       starttime;
     clock_t       endtime;
     struct dsym   *seg;
 
@@ -1445,12 +1627,19 @@ int EXPQUAL AssembleModule( const char *source )
     if ( setjmp( jmpenv ) ) {
         if ( ModuleInfo.g.src_stack )
             ClearSrcStack(); /* avoid memory leaks! */
+        ResWordsFini( FALSE ); /* v2.21: the pass may have been aborted */
         goto done;
     }
 #endif
 
     AssembleInit( source );
 
+#if OBJCACHE
+    /* v2.21: -Fc: if the outputs are in the object cache, no pass is run */
+    if ( ObjCacheLookup() )
+        goto done;
+#endif
+
     starttime = clock();
 
 #if 0 /* 1=trigger a protection fault */
@@ -1517,8 +1706,9 @@ int EXPQUAL AssembleModule( const char *source )
 #endif
         }
 
-        /* set file position of .ASM/.OBJ files for next pass */
-        rewind( CurrFile[ASM] );
+        /* set file position of .OBJ file for next pass.
+         * v2.21: the .ASM file is read from memory, see InputPassInit().
+         */
         if ( write_to_file && Options.output_format == OFORMAT_OMF )
             omf_set_filepos();
 
@@ -1573,6 +1763,9 @@ int EXPQUAL AssembleModule( const char *source )
         LstPrintf( "%s" NLSTR, CurrSource );
     }
 #endif
+#if OBJCACHE
+    ObjCacheCollect( GetLineNumber(), Parse_Pass + 1 );
+#endif
 #if 1 //def __SW_BD
 done:
 #endif
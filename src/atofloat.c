@@ -14,11 +14,164 @@
 #include "globals.h"
 #include "tbyte.h"
 #include "atofloat.h"
+#if FASTFLOAT
+#include "pow5tab.h"
+#endif
 
 #define USESTRTOF 0 /* 0=use strtod() and convert "manually", 1=use strtof() */
 
 extern void myatoi128( const char *, uint_64[], int, int );
 
+#if FASTFLOAT
+
+/* v2.21: decimal to double conversion without strtod().
+ * The result is the correctly rounded double, as returned by strtod().
+ * Cases that aren't handled here ( more than 19 significant digits,
+ * subnormals, overflow, ambiguous rounding ) return FALSE; then
+ * strtod() is used.
+ * - if the mantissa has <= 53 bits and the power of 10 is exact as
+ *   a double, one multiplication/division is enough ( "Clinger" ). This
+ *   requires FLT_EVAL_METHOD 0, that is, no x87 extended precision.
+ * - else the mantissa is multiplied with a 128-bit approximation of
+ *   5^q ( "Eisel-Lemire" ).
+ */
+
+#if defined( FLT_EVAL_METHOD ) && FLT_EVAL_METHOD == 0
+static const double pow10tab[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+#endif
+
+/* 64 x 64 -> 128 bit multiplication; returns the low 64 bits */
+
+static uint_64 mul128( uint_64 a, uint_64 b, uint_64 *hi )
+/********************************************************/
+{
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (uint_64)( r >> 64 );
+    return( (uint_64)r );
+#else
+    uint_64 al = (uint_32)a, ah = a >> 32;
+    uint_64 bl = (uint_32)b, bh = b >> 32;
+    uint_64 ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    uint_64 mid = ( ll >> 32 ) + (uint_32)lh + (uint_32)hl;
+
+    *hi = hh + ( lh >> 32 ) + ( hl >> 32 ) + ( mid >> 32 );
+    return( ( mid << 32 ) | (uint_32)ll );
+#endif
+}
+
+static bool fastatod( const char *p, double *out )
+/************************************************/
+{
+    uint_64 w = 0;
+    uint_64 hi;
+    uint_64 lo;
+    uint_64 hi2;
+    uint_64 mantissa;
+    int     digits = 0;
+    int     q = 0;
+    int     e;
+    int     lz;
+    int     upperbit;
+    int     power2;
+    bool    neg;
+
+    /* scan the mantissa; leading zeros aren't significant */
+    for ( ; *p >= '0' && *p <= '9'; p++ ) {
+        if ( w == 0 && *p == '0' )
+            continue;
+        if ( ++digits > 19 )
+            return( FALSE );
+        w = w * 10 + ( *p - '0' );
+    }
+    if ( *p == '.' )
+        for ( p++; *p >= '0' && *p <= '9'; p++ ) {
+            q--;
+            if ( w == 0 && *p == '0' )
+                continue;
+            if ( ++digits > 19 )
+                return( FALSE );
+            w = w * 10 + ( *p - '0' );
+        }
+    if ( ( *p | 0x20 ) == 'e' ) {
+        neg = FALSE;
+        p++;
+        if ( *p == '+' )
+            p++;
+        else if ( *p == '-' ) {
+            neg = TRUE;
+            p++;
+        }
+        if ( *p < '0' || *p > '9' )
+            return( FALSE );
+        for ( e = 0; *p >= '0' && *p <= '9'; p++ )
+            if ( e < 10000 )
+                e = e * 10 + ( *p - '0' );
+        q += ( neg ? -e : e );
+    }
+    if ( *p != NULLC )
+        return( FALSE );
+
+    if ( w == 0 ) {
+        *out = 0.0;
+        return( TRUE );
+    }
+
+#if defined( FLT_EVAL_METHOD ) && FLT_EVAL_METHOD == 0
+    if ( w <= ( (uint_64)1 << 53 ) && q >= -22 && q <= 22 ) {
+        *out = ( q < 0 ? (double)(int_64)w / pow10tab[-q] : (double)(int_64)w * pow10tab[q] );
+        return( TRUE );
+    }
+#endif
+    if ( q < POW5_MIN || q > POW5_MAX )
+        return( FALSE );
+
+    /* normalize w, then w * 5^q; the upper 55 bits must be exact */
+#ifdef __GNUC__
+    lz = __builtin_clzll( w );
+    w <<= lz;
+#else
+    for ( lz = 0; !( w >> 56 ); lz += 8, w <<= 8 );
+    for ( ; !( w >> 63 ); lz++, w <<= 1 );
+#endif
+    lo = mul128( w, pow5tab[q - POW5_MIN][0], &hi );
+    if ( ( hi & 0x1FF ) == 0x1FF ) {
+        mul128( w, pow5tab[q - POW5_MIN][1], &hi2 );
+        lo += hi2;
+        if ( lo < hi2 )
+            hi++;
+        /* still not sure? only exact for small powers */
+        if ( lo == 0xFFFFFFFFFFFFFFFFULL && ( hi & 0x1FF ) == 0x1FF && ( q < -27 || q > 55 ) )
+            return( FALSE );
+    }
+    upperbit = (int)( hi >> 63 );
+    mantissa = hi >> ( upperbit + 64 - 52 - 3 );
+    /* binary exponent: floor( q * log2(10) ) + 63 + 1023 */
+    power2 = ( ( ( 152170 + 65536 ) * q ) >> 16 ) + 63 + upperbit - lz + 1023;
+    if ( power2 <= 0 ) /* subnormal */
+        return( FALSE );
+
+    /* exactly between two doubles ( possible if 5^q fits in 64 bits ): round to even */
+    if ( lo <= 1 && q >= -4 && q <= 23 && ( mantissa & 3 ) == 1 &&
+        ( mantissa << ( upperbit + 64 - 52 - 3 ) ) == hi )
+        mantissa &= ~(uint_64)1;
+    mantissa += ( mantissa & 1 );
+    mantissa >>= 1;
+    if ( mantissa >= ( (uint_64)2 << 52 ) ) {
+        mantissa = ( (uint_64)1 << 52 );
+        power2++;
+    }
+    if ( power2 >= 0x7FF ) /* overflow */
+        return( FALSE );
+    mantissa = ( mantissa & ~( (uint_64)1 << 52 ) ) | ( (uint_64)power2 << 52 );
+    memcpy( out, &mantissa, sizeof( double ) );
+    return( TRUE );
+}
+
+#endif
+
 /* it's ensured that 'out' points to a buffer with a size of at least 16 */
 
 void atofloat( void *out, const char *inp, unsigned size, bool negative, uint_8 ftype )
@@ -57,6 +210,9 @@ void atofloat( void *out, const char *inp, unsigned size, bool negative, uint_8
             if( negative )
                 float_value *= -1;
 #else
+#if FASTFLOAT
+            if ( !fastatod( inp, &double_value ) )
+#endif
             double_value = strtod( inp, NULL );
             /* v2.06: check FLT_MAX added */
             /* v2.11: check FLT_MIN (min positive value) added */
@@ -73,6 +229,10 @@ void atofloat( void *out, const char *inp, unsigned size, bool negative, uint_8
             break;
         case 8:
             errno = 0; /* v2.11: init errno; errno is set on over- and under-flow */
+#if FASTFLOAT
+            /* v2.21: errno isn't set if fastatod() succeeds */
+            if ( !fastatod( inp, &double_value ) )
+#endif
             double_value = strtod( inp, NULL );
             /* v2.11: check added */
             if ( errno == ERANGE ) {
@@ -40,6 +40,7 @@
 #include "cmdline.h"
 #include "myassert.h"
 #include "input.h" /* GetFNamePart() */
+#include "server.h"
 
 //#ifdef __OSI__
 //  #include "ostype.h"
@@ -89,7 +90,6 @@ struct global_options Options = {
     /* dump_reswords    */          FALSE,
     /* dump_reswords_hash */        FALSE,
     /* dump_symbols     */          FALSE,
-    /* dump_symbols_hash */         FALSE,
     /* display_memalloc */          FALSE,
 #endif
     /* names            */          {
@@ -141,6 +141,18 @@ struct global_options Options = {
     /* all_symbols_public    */     FALSE,
     /* safeseh               */     FALSE,
     /* ignore_include        */     FALSE,
+    /* dump_symbols_hash; v2.21 */  FALSE,
+#if OBJCACHE
+    /* print_cache_stats; v2.21 */  FALSE,
+#endif
+#if defined(__UNIX__)
+    /* cache_incdirs; v2.21  */     FALSE,
+    /* jobs; v2.21           */     0,
+    /* fork_modules; v2.21   */     FALSE,
+#endif
+#if PREFETCH
+    /* read_ahead; v2.21     */     FALSE,
+#endif
     /* output_format         */     OFORMAT_OMF,
     /* sub_format            */     SFORMAT_NONE,
     /* alignment_default     */     0,
@@ -465,6 +477,9 @@ static void OPTQUAL Set_Fi( void ) { queue_item( OPTQ_FINCLUDE, GetAFileName() )
 static void OPTQUAL Set_I( void )  { queue_item( OPTQ_INCPATH,  GetAFileName() ); }
 
 static void OPTQUAL Set_e( void ) { Options.error_limit = OptValue; }
+#if defined(__UNIX__)
+static void OPTQUAL Set_j( void ) { Options.jobs = OptValue; }
+#endif
 
 static void OPTQUAL Set_nologo( void ) { banner_printed = TRUE; }
 static void OPTQUAL Set_q( void )      { Set_nologo(); Options.quiet = TRUE; }
@@ -476,6 +491,19 @@ static void OPTQUAL Set_Fd( void ) { get_fname( OPTN_LNKDEF_FN, GetAFileName() )
 static void OPTQUAL Set_Fw( void ) { get_fname( OPTN_ERR_FN, GetAFileName() ); }
 static void OPTQUAL Set_Fl( void ) { get_fname( OPTN_LST_FN, GetAFileName() ); Options.write_listing = TRUE;}
 static void OPTQUAL Set_Fo( void ) { get_fname( OPTN_OBJ_FN, GetAFileName() ); }
+#if PCHSUPP
+static void OPTQUAL Set_Fp( void ) { get_fname( OPTN_PCH_FN, GetAFileName() ); }
+#endif
+#if OBJCACHE
+/* v2.21: the cache directory isn't handled by get_fname(), it's just a directory name */
+static void OPTQUAL Set_Fc( void )
+/********************************/
+{
+    MemFree( Options.names[OPTN_CACHE_DIR] );
+    Options.names[OPTN_CACHE_DIR] = MemAlloc( strlen( GetAFileName() ) + 1 );
+    strcpy( Options.names[OPTN_CACHE_DIR], GetAFileName() );
+}
+#endif
 
 static void OPTQUAL Set_fp( void ) { Options.cpu &= ~P_FPU_MASK; Options.cpu = OptValue; }
 static void OPTQUAL Set_FPx( void ) { Options.floating_point = OptValue; }
@@ -532,8 +560,12 @@ static void OPTQUAL Set_zt( void ) { Options.stdcall_decoration = OptValue; }
 #ifndef __SW_BD
 /* v2.21: return 0 for -? option */
 //static void OPTQUAL Set_h( void ) {  PrintUsage();  exit(1); }
+#if SERVERSUPP
+static void OPTQUAL Set_h( void ) {  PrintUsage();  ServerExit(0); exit(0); }
+#else
 static void OPTQUAL Set_h( void ) {  PrintUsage();  exit(0); }
 #endif
+#endif
 
 #ifdef DEBUG_OUT
 static void OPTQUAL Set_dm( void )
@@ -607,12 +639,12 @@ static struct cmdloption const cmdl_options[] = {
 #if COFF_SUPPORT && DJGPP_SUPPORT
     { "djgpp",  OFORMAT_COFF | (SFORMAT_DJGPP << 8), Set_ofmt },
 #endif
+    { "dsh",    optofs( dump_symbols_hash ), Set_True }, /* v2.21: also in release version */
 #ifdef DEBUG_OUT
     { "dma",    optofs( display_memalloc ), Set_True },
     { "dm",     0,        Set_dm },
     { "drh",    optofs( dump_reswords_hash ), Set_True },
     { "dr",     optofs( dump_reswords ),    Set_True },
-    { "dsh",    optofs( dump_symbols_hash ), Set_True },
     { "ds",     optofs( dump_symbols ),     Set_True },
     { "dt",     0,        Set_dt },
 #endif
@@ -626,12 +658,19 @@ static struct cmdloption const cmdl_options[] = {
     { "EP",     0,        Set_EP },
     { "eq",     optofs( no_error_disp ),        Set_True },
     { "e=#",    0,        Set_e },
+#if OBJCACHE
+    { "Fcs",    optofs( print_cache_stats ), Set_True },
+    { "Fc=^@",  0,        Set_Fc },
+#endif
 #if DLLIMPORT
     { "Fd=@",   0,        Set_Fd },
 #endif
     { "Fi=^@",  0,        Set_Fi },
     { "Fl=@",   0,        Set_Fl },
     { "Fo=^@",  0,        Set_Fo },
+#if PCHSUPP
+    { "Fp=^@",  0,        Set_Fp },
+#endif
     { "FPi87",  FPO_NO_EMULATION, Set_FPx },
     { "FPi",    FPO_EMULATION,    Set_FPx },
     { "fp0",    P_87,     Set_fp },
@@ -651,6 +690,10 @@ static struct cmdloption const cmdl_options[] = {
     { "h",      0,        Set_h },
 #endif
     { "I=^@",   0,        Set_I },
+#if defined(__UNIX__)
+    { "jf",     optofs( fork_modules ), Set_True },
+    { "j=#",    0,        Set_j },
+#endif
 #ifdef DEBUG_OUT
 #if FASTPASS
     { "ls",     optofs( print_linestore ), Set_True },
@@ -713,6 +756,12 @@ static struct cmdloption const cmdl_options[] = {
     { "win64",  OFORMAT_COFF | (SFORMAT_64BIT << 8), Set_ofmt },
 #endif
     { "w",      0,        Set_w },
+#if defined(__UNIX__)
+    { "Xc",     optofs( cache_incdirs ), Set_True },
+#endif
+#if PREFETCH
+    { "Xr",     optofs( read_ahead ), Set_True },
+#endif
     { "X",      optofs( ignore_include ), Set_True },
     { "Zd",     0,        Set_Zd },
     { "Zf",     optofs( all_symbols_public ),  Set_True },
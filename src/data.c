@@ -1207,6 +1207,9 @@ ret_code data_dir( int i, struct asm_tok tokenarray[], struct asym *type_sym )
     bool                is_float = FALSE;
     int                 idx;
     char                *name;
+#if INVLINES
+    int                 start;
+#endif
 
     DebugMsg1(("data_dir( i=%u, type=%s ) enter\n", i, type_sym ? type_sym->name : "NULL" ));
 
@@ -1416,6 +1419,9 @@ ret_code data_dir( int i, struct asm_tok tokenarray[], struct asym *type_sym )
     }
 
     i++;
+#if INVLINES
+    start = i;
+#endif
     if ( data_item( &i, tokenarray, sym, no_of_bytes, type_sym, 1, CurrStruct != NULL, is_float, TRUE, Token_Count ) == ERROR ) {
         DebugMsg(("data_dir: error in data_item()\n"));
         return( ERROR );
@@ -1426,8 +1432,14 @@ ret_code data_dir( int i, struct asm_tok tokenarray[], struct asym *type_sym )
     }
 
     /* v2.06: update struct size after ALL items have been processed */
-    if ( CurrStruct )
+    if ( CurrStruct ) {
         UpdateStructSize( sym );
+#if INVLINES
+        /* v2.21: in pass two, the initializers of a field are just checked */
+        if ( Parse_Pass == PASS_1 && IsInvariantExpr( start, tokenarray ) )
+            InvLineMark();
+#endif
+    }
 
     if ( ModuleInfo.list )
         //LstWrite( CurrStruct ? LSTTYPE_STRUCT : LSTTYPE_DATA, currofs, sym ); /* v2.18: sym not used by LSTTYPE _STRUCT/_DATA */
@@ -32,6 +32,8 @@
 #include "listing.h"
 #include "omf.h"
 #include "macro.h"
+#include "pch.h"
+#include "objcache.h"
 
 #define  res(token, function) extern ret_code function( int, struct asm_tok[] );
 #include "dirtype.h"
@@ -56,6 +58,12 @@ ret_code EchoDirective( int i, struct asm_tok tokenarray[] )
     if ( Parse_Pass == PASS_1 ) { /* display in pass 1 only */
         if ( Options.preprocessor_stdout == FALSE ) { /* don't print to stdout if -EP is on! */
             printf( "%s\n", tokenarray[i+1].tokpos );
+#if PCHSUPP
+            PchEcho( tokenarray[i+1].tokpos );
+#endif
+#if OBJCACHE
+            ObjCacheEcho( tokenarray[i+1].tokpos, TRUE );
+#endif
         }
     }
 #ifdef DEBUG_OUT
@@ -207,6 +207,7 @@ ret_code EndDirective( int i, struct asm_tok tokenarray[] )
         }
         i = Token_Count + 1;
         tokenarray[i].token = T_ID;
+        tokenarray[i].idlen = 0; /* v2.21: no hash value */
         tokenarray[i].string_ptr = (char *)szStartAddr;
         tokenarray[i+1].token = T_FINAL;
         tokenarray[i+1].string_ptr = "";
@@ -356,6 +356,9 @@ struct asym *CreateConstant( struct asm_tok tokenarray[] )
     ret_code            rc;
     char                *p;
     bool                cmpvalue = FALSE;
+#if INVLINES
+    bool                fixed = TRUE;
+#endif
     struct expr         opnd;
     char                argbuffer[MAX_LINE_LEN];
 
@@ -433,6 +436,9 @@ struct asym *CreateConstant( struct asm_tok tokenarray[] )
                     goto do_single_number;
                 }
             DebugMsg1(("CreateConstant(%s): after ExpandLineItems: >%s<\n", name, p ));
+#if INVLINES
+            fixed = IsInvariantExpr( 2, tokenarray );
+#endif
         }
         rc = EvalOperand( &i, tokenarray, Token_Count, &opnd, EXPF_NOERRMSG | EXPF_NOUNDEF );
 
@@ -500,7 +506,18 @@ struct asym *CreateConstant( struct asm_tok tokenarray[] )
         //    }
         //}
         sym->isvariable = FALSE;
+#if INVLINES
+        /* v2.21: the constant is "fixed" if its value is the same in all passes.
+         * A redefinition with a value that isn't fixed resets the flag.
+         */
+        if ( Parse_Pass == PASS_1 )
+            fixed = ( fixed && opnd.kind == EXPR_CONST && ( sym->isequate == FALSE || sym->is_fixed ) );
+#endif
         SetValue( sym, &opnd );
+#if INVLINES
+        if ( Parse_Pass == PASS_1 )
+            sym->is_fixed = fixed;
+#endif
         DebugMsg1(("CreateConstant(%s): memtype=%Xh value=%" I64_SPEC "X isproc=%u variable=%u type=%s\n",
             name, sym->mem_type, (uint_64)sym->value + ( (uint_64)sym->value3264 << 32), sym->isproc, sym->isvariable, sym->type ? sym->type->name : "NULL" ));
         return( sym );
@@ -509,6 +526,33 @@ struct asym *CreateConstant( struct asm_tok tokenarray[] )
     return ( SetTextMacro( tokenarray, sym, name, argbuffer ) );
 }
 
+#if EQUTABLE
+
+/* v2.21: EQU with a plain number in pass one, before any line is stored.
+ * If the name is new, the constant is added to the compact equate table
+ * ( see symbols.c ) and becomes a symbol when it's used. Listing and -Zi3
+ * need the symbol at once, though.
+ */
+
+bool AddCompactConstant( struct asm_tok tokenarray[] )
+/****************************************************/
+{
+    uint_64 value[2];
+
+    if ( Parse_Pass != PASS_1 || StoreState || ModuleInfo.list ||
+        tokenarray[2].token != T_NUM || Token_Count != 3 ||
+        ( Options.debug_symbols && Options.debug_ext >= CVEX_MAX ) )
+        return( FALSE );
+    /* same check as in CreateConstant() */
+    myatoi128( tokenarray[2].string_ptr, value, tokenarray[2].numbase, tokenarray[2].itemlen );
+    if ( value[1] != 0 || (int_64)value[0] < minintvalues[ModuleInfo.Ofssize] ||
+        (int_64)value[0] > maxintvalues[ModuleInfo.Ofssize] )
+        return( FALSE );
+    return( SymAddEquate( &tokenarray[0], value[0] ) );
+}
+
+#endif
+
 /* EQU directive.
  * This function is called rarely, since EQU
  * is a preprocessor directive handled directly inside PreprocessLine().
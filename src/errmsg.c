@@ -42,6 +42,7 @@
 #include "listing.h"
 #include "segment.h"
 #include "fastpass.h"
+#include "server.h"
 
 extern void             print_source_nesting_structure( void );
 extern jmp_buf          jmpenv;
@@ -222,7 +223,9 @@ static void PrtMsg( int severity, int msgnum, va_list args1, va_list args2 )
     write_logo();
 #endif
     /* open .err file if not already open and a name is given */
-    if( CurrFile[ERR] == NULL && CurrFName[ERR] != NULL ) {
+    if( CurrFile[ERR] == NULL && ExtFile[ERR] != NULL )
+        CurrFile[ERR] = ExtFile[ERR]; /* v2.21: file supplied by the caller */
+    else if( CurrFile[ERR] == NULL && CurrFName[ERR] != NULL ) {
         CurrFile[ERR] = fopen( CurrFName[ERR], "w" );
         if( CurrFile[ERR] == NULL ) {
             /* v2.06: no fatal error anymore if error file cannot be written */
@@ -345,6 +348,9 @@ void Fatal( int msgnum, ... )
      */
     if ( CurrFName[ASM] )
         longjmp( jmpenv, 2 );
+#if SERVERSUPP
+    ServerExit( 1 ); /* v2.21: in a server job, just the job is terminated */
+#endif
 
     exit(1);
 }
@@ -287,7 +287,7 @@ int RunMacro( struct dsym *macro, int idx, struct asm_tok tokenarray[], char *ou
                     i = idx;
                     is_num = TRUE;
                     if ( tokenarray[i].token == T_ID ) {
-                        sym = SymSearch( tokenarray[i].string_ptr );
+                        sym = SymSearchTok( &tokenarray[i] );
                         if ( sym && sym->isdefined &&
                             ( sym->state == SYM_TMACRO ||
                              ( sym->state == SYM_MACRO && sym->isfunc == TRUE && tokenarray[i+1].token == T_OP_BRACKET ) ) )
@@ -463,7 +463,7 @@ int RunMacro( struct dsym *macro, int idx, struct asm_tok tokenarray[], char *ou
                      */
                     if ( tokenarray[idx].token == T_ID ) {
                         DebugMsg1(("RunMacro(%s.%u): T_ID token found\n", macro->sym.name, parmidx ));
-                        if ( sym = SymSearch( tokenarray[idx].string_ptr ) ) {
+                        if ( sym = SymSearchTok( &tokenarray[idx] ) ) {
                             if ( sym->state == SYM_MACRO && sym->isdefined == TRUE &&
                                 sym->isfunc == TRUE && tokenarray[idx+1].token == T_OP_BRACKET ) {
                                 bool is_exitm2;
@@ -1032,7 +1032,7 @@ static ret_code ExpandTMacro( char * const outbuf, struct asm_tok tokenarray[],
         expanded = FALSE;
         for ( ; i < Token_Count; i++ ) {
             if ( tokenarray[i].token == T_ID ) {
-                sym = SymSearch( tokenarray[i].string_ptr );
+                sym = SymSearchTok( &tokenarray[i] );
                 /* expand macro functions */
                 if ( sym && sym->state == SYM_MACRO &&
                     sym->isdefined == TRUE && sym->isfunc == TRUE &&
@@ -1186,7 +1186,7 @@ static ret_code ExpandToken( char *line, int *pi, struct asm_tok tokenarray[], i
             continue;
         }
         if( tokenarray[i].token == T_ID ) {
-            sym = SymSearch( tokenarray[i].string_ptr );
+            sym = SymSearchTok( &tokenarray[i] );
             DebugMsg1(("ExpandToken: testing id >%s< equmode=%u\n", tokenarray[i].string_ptr, equmode ));
             /* don't check isdefined flag (which cannot occur in pass one, and this code usually runs
              * in pass one only!
@@ -1515,7 +1515,7 @@ ret_code ExpandLine( char *string, struct asm_tok tokenarray[] )
                 count = 2;
                 break;
             case DRT_MACRO:
-                sym = SymSearch( tokenarray[0].string_ptr );
+                sym = SymSearchTok( &tokenarray[0] );
                 /* don't expand macro DEFINITIONs!
                  * the name is an exception, if it's not the macro itself
                  */
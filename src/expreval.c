@@ -300,6 +300,34 @@ static uint_32 GetRecordMask( struct dsym *record )
     return( mask );
 }
 
+/* v2.21: convert 8 hexadecimal/decimal digits at once ( SWAR ).
+ * the digits have been checked by the tokenizer.
+ */
+static uint_32 hex8( const char *src )
+/************************************/
+{
+    uint_64 v;
+
+    memcpy( &v, src, sizeof( v ) );
+    /* digit values; 'A'-'F' and 'a'-'f' have bit 6 set */
+    v = ( v & 0x0F0F0F0F0F0F0F0FULL ) + ( ( v >> 6 ) & 0x0101010101010101ULL ) * 9;
+    /* combine neighbours; the first char is the most significant digit */
+    v = ( ( v << 4 ) | ( v >> 8 ) ) & 0x00FF00FF00FF00FFULL;
+    v = ( ( v << 8 ) | ( v >> 16 ) ) & 0x0000FFFF0000FFFFULL;
+    return( (uint_32)( ( v << 16 ) | ( v >> 32 ) ) );
+}
+
+static uint_32 dec8( const char *src )
+/************************************/
+{
+    uint_64 v;
+
+    memcpy( &v, src, sizeof( v ) );
+    v = ( ( v & 0x0F0F0F0F0F0F0F0FULL ) * ( 10 * 0x100 + 1 ) ) >> 8;
+    v = ( ( v & 0x00FF00FF00FF00FFULL ) * ( 100 * 0x10000 + 1 ) ) >> 16;
+    return( (uint_32)( ( ( v & 0x0000FFFF0000FFFFULL ) * ( 10000 * 0x100000000ULL + 1 ) ) >> 32 ) );
+}
+
 /* v2.06: the value of number strings is now evaluated here.
  * Prior to v2.06, it was evaluated in the tokenizer and the
  * value was stored in the token string buffer. Since the content
@@ -310,13 +338,36 @@ static uint_32 GetRecordMask( struct dsym *record )
 void myatoi128( const char *src, uint_64 dst[], int base, int size )
 /******************************************************************/
 {
+    /* v2.21: max. number of digits that surely fit in 64 bits, for base 2-16 */
+    static const uint_8 maxdigits[] = { 0, 0, 64, 40, 32, 27, 24, 22, 21, 20, 19, 18, 17, 17, 16, 16, 16 };
     uint_32             val;
     unsigned            len;
     const char          *end = src + size;
     uint_16             *px;
+    uint_64             value;
 
-    dst[0] = 0;
     dst[1] = 0;
+    /* v2.21: fast path, the 128-bit loop below is needed for long numbers only */
+    if ( size <= maxdigits[base] ) {
+        value = 0;
+        if ( base == 16 ) {
+            for ( ; end - src >= 8; src += 8 )
+                value = ( value << 32 ) | hex8( src );
+            for ( ; src < end; src++ )
+                value = ( value << 4 ) | ( *src <= '9' ? *src - '0' : ( *src | 0x20 ) - 'a' + 10 );
+        } else if ( base == 10 ) {
+            for ( ; end - src >= 8; src += 8 )
+                value = value * 100000000 + dec8( src );
+            for ( ; src < end; src++ )
+                value = value * 10 + ( *src - '0' );
+        } else {
+            for ( ; src < end; src++ )
+                value = value * base + ( *src <= '9' ? *src - '0' : ( *src | 0x20 ) - 'a' + 10 );
+        }
+        dst[0] = value;
+        return;
+    }
+    dst[0] = 0;
     do {
         val = ( *src <= '9' ? *src - '0' : ( *src | 0x20 ) - 'a' + 10 );
         px = (uint_16 *)dst;
@@ -442,11 +493,11 @@ static ret_code get_operand( struct expr *opnd, int *idx, struct asm_tok tokenar
         if ( opnd->is_dot ) {
             DebugMsg1(("%u get_operand: T_ID, is_dot=1, id=%s, opnd.type=%s\n", evallvl, tokenarray[i].string_ptr, opnd->type ? opnd->type->name : "NULL" ));
             opnd->value = 0;
-            sym = ( opnd->type ? SearchNameInStruct( opnd->type, tmp, &opnd->uvalue, 0 ) : NULL );
+            sym = ( opnd->type ? SearchTokInStruct( opnd->type, &tokenarray[i], &opnd->uvalue ) : NULL );
             DebugMsg1(("get_operand(%s): is_dot, sym=%s, offset=%" I32_SPEC "Xh\n",
                        tmp, sym ? sym->name : "NULL", opnd->uvalue ));
             if ( sym == NULL ) {
-                sym = SymSearch( tmp );
+                sym = SymSearchTok( &tokenarray[i] );
                 if ( sym ) {
                     /*
                      * skip a type specifier matching the data item's type
@@ -516,7 +567,11 @@ static ret_code get_operand( struct expr *opnd, int *idx, struct asm_tok tokenar
                 else if (*(tmp+1) == 'f' || *(tmp+1 ) == 'F' )
                     tmp = GetAnonymousLabel( labelbuff, 1 );
             }
-            sym = SymSearch( tmp );
+            /* v2.21: use the hash value supplied by the tokenizer */
+            if ( tmp == tokenarray[i].string_ptr )
+                sym = SymSearchTok( &tokenarray[i] );
+            else
+                sym = SymSearch( tmp );
         }
         if ( sym == NULL ||
             sym->state == SYM_UNDEFINED ||
@@ -560,7 +615,7 @@ static ret_code get_operand( struct expr *opnd, int *idx, struct asm_tok tokenar
                     /* v2.11: flag EXPF_NOLCREATE has got another meaning */
                     //if ( opnd->type == NULL && !( flags & EXPF_NOLCREATE ) ) { /* added v1.95 */
                     if ( opnd->type == NULL ) {
-                        sym = SymLookup( tmp );
+                        sym = ( tmp == tokenarray[i].string_ptr ? SymLookupTok( &tokenarray[i] ) : SymLookup( tmp ) );
                         /* v2.18: don't insert an already defined symbol to the "undefined" list;
                          * "undefined" symbols, procs and stack variables all use the same field to link to
                          * their "successor".
@@ -28,6 +28,7 @@
 #include "condasm.h"
 #include "proc.h"
 #include "extern.h"
+#include "tokenize.h"
 
 #if ELF_SUPPORT
 #define EXTERNEXP 1 /* v2.21: syntax extension for EXTERNDEF - accept EXPORT attribute */
@@ -56,6 +57,10 @@
  */
 #define MASM_NOSEGSTORE 0  /* 1 is Masm compatible */
 
+#if LAZYPROTO
+extern char *token_stringbuf;
+#endif
+
 static const char szCOMM[] = "COMM";
 
 #if MANGLERSUPP
@@ -591,6 +596,165 @@ ret_code ExterndefDirective( int i, struct asm_tok tokenarray[] )
     return( NOT_ERROR );
 }
 
+#if LAZYPROTO
+
+/* v2.21: a PROTO that introduces a new name isn't parsed at once; just the
+ * text behind PROTO is stored, together with the module settings that are
+ * used by ParseProc(). The prototype is completed when the name is found
+ * by SymFindHash() the first time. Unused prototypes - the majority in
+ * include files like windows.inc - thus never get a proc_info and a
+ * parameter list. To ensure that errors are still reported for the PROTO
+ * line, deferring is restricted to prototypes that pass IsSimpleProto().
+ */
+
+struct lazy_proto {
+    uint_8 langtype;
+    uint_8 Ofssize;
+    uint_8 model;
+    uint_8 fctype;
+    uint_8 wordsize;
+    char   text[1];
+};
+
+/* check that the tokens are [distance] [langtype] [,] {[name]:type ,}
+ * with type being {[distance] PTR} [simple type | type name].
+ */
+
+static bool IsSimpleProto( int i, struct asm_tok tokenarray[], enum lang_type langtype )
+/**************************************************************************************/
+{
+    struct asym *sym;
+
+    if ( tokenarray[i].token == T_STYPE &&
+        tokenarray[i].tokval >= T_NEAR && tokenarray[i].tokval <= T_FAR32 )
+        i++;
+    GetLangType( &i, tokenarray, &langtype );
+    if ( tokenarray[i].token == T_COMMA )
+        i++;
+    if ( tokenarray[i].token == T_FINAL )
+        return( TRUE );
+    if ( langtype == LANG_NONE )
+        return( FALSE );
+    for ( ;; i++ ) {
+        if ( tokenarray[i].token == T_ID )
+            i++;
+        if ( tokenarray[i].token != T_COLON )
+            return( FALSE );
+        i++;
+        if ( tokenarray[i].token == T_COMMA || tokenarray[i].token == T_FINAL )
+            return( FALSE );
+        for ( ; tokenarray[i].token != T_COMMA && tokenarray[i].token != T_FINAL; i++ ) {
+            if ( tokenarray[i].token == T_BINARY_OPERATOR && tokenarray[i].tokval == T_PTR )
+                continue;
+            if ( tokenarray[i+1].token != T_COMMA && tokenarray[i+1].token != T_FINAL ) {
+                /* a distance must be followed by PTR */
+                if ( tokenarray[i].token != T_STYPE ||
+                    tokenarray[i+1].token != T_BINARY_OPERATOR || tokenarray[i+1].tokval != T_PTR )
+                    return( FALSE );
+            } else if ( tokenarray[i].token == T_ID ) {
+                sym = SymPeekTok( &tokenarray[i] );
+                if ( sym == NULL || sym->state != SYM_TYPE )
+                    return( FALSE );
+            } else if ( tokenarray[i].token != T_STYPE )
+                return( FALSE );
+        }
+        if ( tokenarray[i].token == T_FINAL )
+            return( TRUE );
+    }
+}
+
+/* create the placeholder of a deferred PROTO.
+ * returns FALSE if the PROTO is to be parsed now.
+ */
+
+static bool DeferProto( struct asm_tok tokenarray[] )
+/***************************************************/
+{
+    struct asym *sym;
+    struct lazy_proto *lp;
+    int len;
+
+    if ( tokenarray[0].token != T_ID ||
+#if DLLIMPORT
+        ModuleInfo.CurrDll ||
+#endif
+        SymPeekTok( &tokenarray[0] ) ||
+        IsSimpleProto( 2, tokenarray, ModuleInfo.langtype ) == FALSE )
+        return( FALSE );
+
+    sym = SymLookupTok( &tokenarray[0] );
+    len = strlen( tokenarray[2].tokpos );
+    lp = LclAlloc( sizeof( struct lazy_proto ) + len );
+    lp->langtype = ModuleInfo.langtype;
+    lp->Ofssize = ModuleInfo.Ofssize;
+    lp->model = ModuleInfo.model;
+    lp->fctype = ModuleInfo.fctype;
+    lp->wordsize = CurrWordSize;
+    memcpy( lp->text, tokenarray[2].tokpos, len + 1 );
+    DebugMsg1(("DeferProto(%s): >%s<\n", sym->name, lp->text ));
+
+    /* see CreateProc() */
+    sym->state = SYM_EXTERNAL;
+    sym->seg_ofssize = ModuleInfo.Ofssize;
+    sym->isweak = TRUE;
+    sym->isdeferred = TRUE;
+    ((struct dsym *)sym)->e.lazyinfo = lp;
+    sym_add_table( &SymTables[TAB_EXT], (struct dsym *)sym );
+    return( TRUE );
+}
+
+/* parse a deferred PROTO. This may happen while another line is
+ * processed, so the text gets its own token and string buffers.
+ */
+
+void CompleteProto( struct asym *sym )
+/************************************/
+{
+    struct dsym *dir = (struct dsym *)sym;
+    struct lazy_proto *lp = dir->e.lazyinfo;
+    struct proc_info *info;
+    struct asm_tok *tokenarray;
+    char *line;
+    char *oldstringbuf = token_stringbuf;
+    char *oldstringend = StringBufferEnd;
+    int oldcount = Token_Count;
+    uint_8 oldOfssize = ModuleInfo.Ofssize;
+    enum model_type oldmodel = ModuleInfo.model;
+    enum fastcall_type oldfctype = ModuleInfo.fctype;
+    uint_8 oldwordsize = CurrWordSize;
+
+    DebugMsg1(("CompleteProto(%s): >%s<\n", sym->name, lp->text ));
+    sym->isdeferred = FALSE;
+    info = LclAlloc( sizeof( struct proc_info ) );
+    memset( info, 0, sizeof( struct proc_info ) );
+    dir->e.procinfo = info;
+
+    line = MemAlloc( MAX_LINE_LEN + sizeof( struct asm_tok ) * MAX_TOKEN + MAX_LINE_LEN * 2 );
+    tokenarray = (struct asm_tok *)( line + MAX_LINE_LEN );
+    token_stringbuf = (char *)( tokenarray + MAX_TOKEN );
+    strcpy( line, lp->text );
+    Token_Count = Tokenize( line, 0, tokenarray, TOK_RESCAN );
+
+    ModuleInfo.Ofssize = lp->Ofssize;
+    ModuleInfo.model = lp->model;
+    ModuleInfo.fctype = lp->fctype;
+    CurrWordSize = lp->wordsize;
+    ParseProc( dir, 0, tokenarray, FALSE, lp->langtype );
+    ModuleInfo.Ofssize = oldOfssize;
+    ModuleInfo.model = oldmodel;
+    ModuleInfo.fctype = oldfctype;
+    CurrWordSize = oldwordsize;
+
+    token_stringbuf = oldstringbuf;
+    StringBufferEnd = oldstringend;
+    Token_Count = oldcount;
+    MemFree( line );
+    LclFree( lp );
+    return;
+}
+
+#endif
+
 /* PROTO directive.
  * <name> PROTO <params> is semantically identical to:
  * EXTERNDEF <name>: PROTO <params>
@@ -602,7 +766,12 @@ ret_code ProtoDirective( int i, struct asm_tok tokenarray[] )
     if( Parse_Pass != PASS_1 ) {
         struct asym *sym;
         /* v2.04: set the "defined" flag */
-        if ( ( sym = SymSearch( tokenarray[0].string_ptr ) ) && sym->isproc == TRUE )
+        /* v2.21: SymPeekTok() doesn't complete a deferred PROTO */
+        if ( ( sym = SymPeekTok( &tokenarray[0] ) ) && ( sym->isproc == TRUE
+#if LAZYPROTO
+            || sym->isdeferred
+#endif
+           ) )
             sym->isdefined = TRUE;
         return( NOT_ERROR );
     }
@@ -610,7 +779,15 @@ ret_code ProtoDirective( int i, struct asm_tok tokenarray[] )
         return( EmitErr( SYNTAX_ERROR_EX, tokenarray[i].string_ptr ) );
     }
 
-    return( CreateProto( 2, tokenarray, tokenarray[0].string_ptr, ModuleInfo.langtype ) ? NOT_ERROR : ERROR );
+#if LAZYPROTO
+    if ( DeferProto( tokenarray ) == FALSE )
+#endif
+    if ( CreateProto( 2, tokenarray, tokenarray[0].string_ptr, ModuleInfo.langtype ) == NULL )
+        return( ERROR );
+#if INVLINES
+    InvLineMark(); /* v2.21: pass two just sets the "defined" flag */
+#endif
+    return( NOT_ERROR );
 }
 
 /* helper for EXTERN directive.
@@ -895,6 +1072,8 @@ ret_code ExternDirective( int i, struct asm_tok tokenarray[] )
 static struct asym *MakeComm( char *name, struct asym *sym, uint_32 size, uint_32 count, bool isfar )
 /***************************************************************************************************/
 {
+    enum memtype mem_type;
+
     sym = CreateComm( sym, name );
     if( sym == NULL )
         return( NULL );
@@ -906,7 +1085,9 @@ static struct asym *MakeComm( char *name, struct asym *sym, uint_32 size, uint_3
     if ( Options.masm_compat_gencode == FALSE || isfar == FALSE )
         sym->segment = &CurrSeg->sym;
 
-    MemtypeFromSize( size, &sym->mem_type );
+    /* mem_type is unchanged if size doesn't match a simple type */
+    if ( MemtypeFromSize( size, &mem_type ) == NOT_ERROR )
+        sym->mem_type = mem_type;
 
     /* v2.04: warning added ( Masm emits an error ) */
     /* v2.05: code active for 16-bit only */
@@ -26,6 +26,7 @@
 #include "segment.h"
 #include "fastpass.h"
 #include "listing.h"
+#include "pch.h"
 
 #include "myassert.h"
 
@@ -68,6 +69,52 @@ struct mod_state {
 
 static struct mod_state modstate; /* struct to store assembly status */
 
+#if TOKSTORE
+/* tok_item: the tokens of a stored line, as created by Tokenize().
+ * The token array ( count + 1 items, including T_FINAL ) is followed
+ * by the token strings. The pointers of the tokens remain valid, since
+ * the line item and the token string buffer don't move.
+ */
+struct tok_item {
+    unsigned count;
+    unsigned strsize;
+    struct asm_tok tokens[1];
+};
+
+extern char *token_stringbuf;
+#endif
+
+#if INVLINES
+/* inv_equ: a stored EQU line. It's pass-invariant if the constant is
+ * still "fixed" at the end of pass one; see DefSavedState().
+ */
+struct inv_equ {
+    struct inv_equ *next;
+    struct line_item *line;
+    struct asym *sym;
+};
+
+static struct {
+    struct inv_equ *head;
+    struct inv_equ *tail;
+} InvEqu;
+
+/* a top-level STRUCT/UNION definition. Its lines are pass-invariant
+ * if all lines stored inside the block are.
+ */
+static struct {
+    bool active;
+    struct line_item *start; /* the STRUCT line */
+    uint_32 stored;          /* value of cntstored before the STRUCT line */
+    uint_32 marked;          /* pass-invariant lines inside the block */
+    unsigned warnings;       /* warning count at the STRUCT line */
+} InvBlock;
+
+static uint_32 cntstored; /* lines stored in pass one */
+
+static bool IsFixedEquate( const struct asym * );
+#endif
+
 static struct {
     struct line_item *head;
     struct line_item *tail;
@@ -114,6 +161,9 @@ static void SaveState( void )
     SegmentSaveState();
     AssumeSaveState();
     ContextSaveState(); /* save pushcontext/popcontext stack */
+#if PCHSUPP
+    PchSaveState();
+#endif
 
     DebugMsg1(( "SaveState exit\n" ));
 }
@@ -147,6 +197,13 @@ void StoreLine( const char *srcline )
     LineStoreCurr->next = NULL;
     LineStoreCurr->lineno = GetLineNumber();
     LineStoreCurr->pList = NULL; /* v2.19 */
+#if TOKSTORE
+    LineStoreCurr->tokens = NULL;
+#endif
+#if INVLINES
+    LineStoreCurr->invariant = FALSE;
+    cntstored++;
+#endif
     if ( MacroLevel ) {
         LineStoreCurr->srcfile = 0xfff;
     } else {
@@ -184,8 +241,18 @@ void StoreLine( const char *srcline )
 void DefSavedState( void )
 /*************************/
 {
+#if INVLINES
+    struct inv_equ *p;
+#endif
     UseSavedState = ( StoreState && ReqSavedState );
     StoreState = FALSE;
+#if INVLINES
+    /* v2.21: classify the stored EQU lines */
+    if ( UseSavedState )
+        for ( p = InvEqu.head; p; p = p->next )
+            if ( IsFixedEquate( p->sym ) )
+                p->line->invariant = TRUE;
+#endif
 }
 /* an error has been detected in pass one. it should be
  reported in pass 2, so ensure that a full source scan is done then
@@ -406,12 +473,205 @@ void FreeLineStore( void )
     struct line_item *next;
     for ( LineStoreCurr = LineStore.head; LineStoreCurr; ) {
         next = LineStoreCurr->next;
+#if TOKSTORE
+        if ( LineStoreCurr->tokens )
+            LclFree( LineStoreCurr->tokens );
+#endif
         LclFree( LineStoreCurr );
         LineStoreCurr = next;
     }
 }
 #endif
 
+#if TOKSTORE
+
+/* v2.21: save the tokens of the current stored line. Called in pass two,
+ * directly after Tokenize(); the tokens are used by further passes
+ * instead of tokenizing the line again.
+ */
+void StoreTokens( struct asm_tok tokenarray[], int count )
+/********************************************************/
+{
+    struct tok_item *ti;
+    unsigned toksize = ( count + 1 ) * sizeof( struct asm_tok );
+    unsigned strsize = StringBufferEnd - token_stringbuf;
+    int i;
+
+    /* lines that affect the state of conditional assembly or start
+     * a COMMENT block are tokenized in each pass.
+     */
+    if ( ModuleInfo.inside_comment )
+        return;
+    i = ( count > 2 && ( tokenarray[1].token == T_COLON || tokenarray[1].token == T_DBL_COLON ) ? 2 : 0 );
+    if ( ( tokenarray[0].token == T_DIRECTIVE && tokenarray[0].dirtype == DRT_CONDDIR ) ||
+        ( tokenarray[i].token == T_DIRECTIVE && tokenarray[i].dirtype == DRT_CONDDIR ) )
+        return;
+
+    ti = LclAlloc( sizeof( struct tok_item ) - sizeof( struct asm_tok ) + toksize + strsize );
+    ti->count = count;
+    ti->strsize = strsize;
+    memcpy( ti->tokens, tokenarray, toksize );
+    memcpy( (char *)ti->tokens + toksize, token_stringbuf, strsize );
+    LineStoreCurr->tokens = ti;
+}
+
+/* v2.21: restore the tokens of the current stored line; returns the
+ * number of tokens, like Tokenize().
+ */
+int LoadTokens( struct asm_tok tokenarray[] )
+/*******************************************/
+{
+    struct tok_item *ti = LineStoreCurr->tokens;
+    unsigned toksize = ( ti->count + 1 ) * sizeof( struct asm_tok );
+
+    memcpy( tokenarray, ti->tokens, toksize );
+    memcpy( token_stringbuf, (char *)ti->tokens + toksize, ti->strsize );
+    StringBufferEnd = token_stringbuf + ti->strsize;
+    return( ti->count );
+}
+
+#endif
+
+#if INVLINES
+
+/* v2.21: pass-invariant lines.
+ * In pass one, lines whose effect cannot change in further passes are
+ * marked: PROTO, TYPEDEF and RECORD lines, STRUCT/UNION definitions and
+ * EQU lines that define "fixed" constants. Such lines aren't replayed
+ * after pass one, their effect is kept from pass one.
+ */
+
+static bool IsFixedEquate( const struct asym *sym )
+/*************************************************/
+{
+    return( sym->state == SYM_INTERNAL && sym->isequate && sym->isvariable == FALSE &&
+           sym->predefined == FALSE && sym->mem_type == MT_EMPTY && sym->segment == NULL &&
+           sym->is_fixed );
+}
+
+/* check if an expression - or the initializers of a struct field - has
+ * the same value in all passes. Accepted are numbers, operators, types and
+ * "fixed" equates; labels, $ and THIS are not.
+ */
+bool IsInvariantExpr( int i, const struct asm_tok tokenarray[] )
+/**************************************************************/
+{
+    struct asym *sym;
+
+    for ( ; tokenarray[i].token != T_FINAL; i++ ) {
+        switch ( tokenarray[i].token ) {
+        case T_NUM:
+        case T_FLOAT:
+        case T_STRING:
+        case T_STYPE:
+        case T_BINARY_OPERATOR:
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case T_OP_BRACKET:
+        case T_CL_BRACKET:
+        case T_COMMA:
+        case T_QUESTION_MARK:
+            break;
+        case T_UNARY_OPERATOR:
+            if ( tokenarray[i].tokval == T_THIS )
+                return( FALSE );
+            break;
+        case T_RES_ID:
+            if ( tokenarray[i].tokval != T_DUP )
+                return( FALSE );
+            break;
+        case T_ID:
+            sym = SymSearch( tokenarray[i].string_ptr );
+            if ( sym == NULL )
+                return( FALSE );
+            if ( sym->state == SYM_TYPE && sym->isdefined )
+                break;
+            if ( !IsFixedEquate( sym ) )
+                return( FALSE );
+            break;
+        default:
+            return( FALSE );
+        }
+    }
+    return( TRUE );
+}
+
+/* mark the current line - it has been stored already - as pass-invariant.
+ * Inside a STRUCT definition the line is just counted.
+ */
+void InvLineMark( void )
+/**********************/
+{
+    if ( StoreState == FALSE || ModuleInfo.GeneratedCode )
+        return;
+    if ( InvBlock.active )
+        InvBlock.marked++;
+    else
+        LineStoreCurr->invariant = TRUE;
+}
+
+/* the current line is an EQU that has defined a numeric constant */
+
+void InvLineEqu( struct asym *sym )
+/*********************************/
+{
+    struct inv_equ *p;
+
+    if ( StoreState == FALSE || ModuleInfo.GeneratedCode || InvBlock.active )
+        return;
+    p = LclAlloc( sizeof( struct inv_equ ) );
+    p->next = NULL;
+    p->line = LineStoreCurr;
+    p->sym = sym;
+    if ( InvEqu.tail )
+        InvEqu.tail->next = p;
+    else
+        InvEqu.head = p;
+    InvEqu.tail = p;
+}
+
+/* called by StructDirective() for a top-level STRUCT/UNION in pass one */
+
+void InvBlockStart( void )
+/************************/
+{
+    InvBlock.active = TRUE;
+    InvBlock.start = ( ( StoreState && ModuleInfo.GeneratedCode == FALSE ) ? LineStoreCurr : NULL );
+    InvBlock.stored = cntstored - 1;
+    InvBlock.marked = 0;
+    InvBlock.warnings = ModuleInfo.g.warning_count;
+}
+
+/* called by EndstructDirective() when the top-level struct is closed */
+
+void InvBlockEnd( void )
+/**********************/
+{
+    struct line_item *curr;
+
+    if ( InvBlock.start && cntstored - InvBlock.stored == InvBlock.marked &&
+        ModuleInfo.g.warning_count == InvBlock.warnings ) {
+        DebugMsg1(("InvBlockEnd: %" I32_SPEC "u lines pass-invariant\n", InvBlock.marked ));
+        for ( curr = InvBlock.start; curr; curr = curr->next )
+            curr->invariant = TRUE;
+    }
+    InvBlock.active = FALSE;
+}
+
+#endif
+
+#if PCHSUPP
+/* v2.21: get the start of the line store; used by -Fp */
+
+struct line_item *GetLineStore( void )
+/************************************/
+{
+    return( LineStore.head );
+}
+#endif
+
 /* called by AssembleInit() once per module. */
 
 void FastpassInit( void )
@@ -423,6 +683,12 @@ void FastpassInit( void )
     LineStore.tail = NULL;
     UseSavedState = FALSE;
     ReqSavedState = TRUE;
+#if INVLINES
+    InvEqu.head = NULL;
+    InvEqu.tail = NULL;
+    InvBlock.active = FALSE;
+    cntstored = 0;
+#endif
 }
 
 #endif
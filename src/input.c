@@ -29,7 +29,15 @@
 ****************************************************************************/
 
 #include <ctype.h>
+#include <errno.h>
 //#include <stdarg.h> /* v2.12: removed - was necessary for _splitpath()/_makepath() */
+#include <sys/stat.h>
+#if defined(__UNIX__) && defined(__GNUC__)
+    #include <sys/mman.h>
+#endif
+#if defined(__UNIX__)
+    #include <dirent.h>
+#endif
 
 #include "globals.h"
 #include "memalloc.h"
@@ -37,7 +45,10 @@
 #include "macro.h"
 #include "input.h"
 #include "lqueue.h"
+#include "reswords.h"
 #include "myassert.h"
+#include "objcache.h"
+#include "prefetch.h"
 
 #define DETECTCTRLZ 1 /* 1=Ctrl-Z in input stream will skip rest of the file */
 
@@ -49,6 +60,30 @@
 
 #define FILESEQ 0
 
+/* INCCACHE: if 1, the content of include files is cached, so they're
+ * read just once, even if they're included by multiple modules.
+ */
+#define INCCACHE 1
+
+/* PATHCACHE: if 1, paths which couldn't be opened are remembered,
+ * so the search for an include file won't try to open them again.
+ * In Unix, if cmdline option -Xc is set, the contents of directories
+ * are read once and then used instead of trying to open files.
+ */
+#define PATHCACHE 1
+
+/* INCGUARD: if 1, include files are checked for a "multiple-include guard"
+ * ( IFNDEF <sym> ... ENDIF enclosing the whole file ). If such a file is
+ * included again and <sym> is defined, the file isn't read at all.
+ */
+#define INCGUARD 1
+
+#if defined(__UNIX__) || defined(__CYGWIN__) || defined(__DJGPP__)
+#define _stat   stat
+#define _fstat  fstat
+#define _fileno fileno
+#endif
+
 char   *commentbuffer;
 
 struct asym *FileCur; /* @FileCur symbol, created in SymInit() */
@@ -59,6 +94,28 @@ enum src_item_type {
     SIT_MACRO,
 };
 
+/* v2.21: the content of a source file is read into memory at once;
+ * if possible, the file is mapped.
+ */
+struct src_buffer {
+    const char          *base;      /* start of file content */
+    const char          *end;       /* end of file content */
+    size_t              size;       /* size of allocated/mapped block */
+    uint_8              mapped;     /* 1=block is mapped, 0=block is in C heap */
+#if INCCACHE
+    uint_8              cached;     /* 1=item is in include file cache */
+    unsigned            refcnt;     /* number of src items using the buffer */
+    struct src_buffer   *next;      /* next item in include file cache */
+    char                *fname;     /* cache key: path of file, */
+    time_t              mtime;      /* modification time */
+    size_t              fsize;      /* and size of file */
+#if SERVERSUPP
+    dev_t               dev;        /* the path may be relative, and the */
+    ino_t               ino;        /* server changes the current directory */
+#endif
+#endif
+};
+
 /* item on src stack ( contains currently open source files & macros ) */
 struct src_item {
     struct src_item     *next;
@@ -70,6 +127,8 @@ struct src_item {
         struct macro_instance *mi;  /* if item is a macro */
     };
     uint_32             line_num;   /* current line # */
+    struct src_buffer   *sb;        /* v2.21: file content if item is a file */
+    const char          *curr;      /* v2.21: read position in file content */
     /* v2.11 field macro moved to struct macro_instance */
     //struct asym         *macro;     /* the symbol if it is a macro */
 };
@@ -77,6 +136,31 @@ struct src_item {
 /* v2.11: introduced a list of unused src_items */
 static struct src_item *SrcFree;
 
+#if INCCACHE
+/* v2.21: cache of include files. It's global, that is,
+ * it's not reset if another module is assembled.
+ */
+static struct src_buffer *SrcCache;
+#endif
+
+#if PATHCACHE
+/* v2.21: path cache item; the caches are global, like SrcCache. */
+struct path_item {
+    struct path_item    *next;
+    char                name[1];
+};
+
+#define PC_NOTFOUND_SIZE  256   /* size of hash table for paths not found */
+#define PC_DIRS_SIZE      64    /* size of hash table for directories read */
+#define PC_FOUND_SIZE     2048  /* size of hash table for directory entries */
+
+static struct path_item *NotFound[PC_NOTFOUND_SIZE]; /* paths which couldn't be opened */
+#if defined(__UNIX__)
+static struct path_item *DirsRead[PC_DIRS_SIZE];     /* directories that have been read ( -Xc ) */
+static struct path_item *Found[PC_FOUND_SIZE];       /* entries of directories read ( -Xc ) */
+#endif
+#endif
+
 #define src_stack  ModuleInfo.g.src_stack
 
 #if FILESEQ
@@ -88,6 +172,9 @@ struct asm_tok *end_tokenarray;
 char           *end_stringbuf;
 static int_32 cntflines;  /* count file lines ( read by fgets() ) */
 static int_32 cntlines;   /* count lines read by GetTextLine() */
+#if SKIPSCAN
+static int_32 cntslines;  /* count lines skipped by SkipFalseLines() */
+#endif
 extern int_32 cnttok0;    /* count Tokenize() calls, index==0 */
 extern int_32 cnttok1;    /* count Tokenize() calls, index!=0 */
 extern int_32 cntppl0;    /* count preprocessed lines 1 */
@@ -219,6 +306,7 @@ static unsigned AddFile( char const *fname )
 
     ModuleInfo.g.FNames[index].fname = (char *)LclAlloc( strlen( fname ) + 1 );
     strcpy( ModuleInfo.g.FNames[index].fname, fname );
+    ModuleInfo.g.FNames[index].guard = NULL; /* v2.21 */
     /* v2.11: field fullname removed */
     //ModuleInfo.g.FNames[index].fullname = (char *)LclAlloc( strlen( fullname ) + 1 );
     //strcpy( ModuleInfo.g.FNames[index].fullname, fullname );
@@ -226,6 +314,19 @@ static unsigned AddFile( char const *fname )
     return( index );
 }
 
+#if PCHSUPP
+/* v2.21: add a file name and its include guard; used by -Fp */
+
+unsigned AddFileName( const char *fname, char *guard )
+/****************************************************/
+{
+    unsigned index = AddFile( fname );
+
+    ModuleInfo.g.FNames[index].guard = guard;
+    return( index );
+}
+#endif
+
 const struct fname_item *GetFName( unsigned index )
 /*************************************************/
 {
@@ -271,6 +372,211 @@ static void FreeFiles( void )
     return;
 }
 
+/* v2.21: read the content of a source file into memory.
+ * on Unix, the file is mapped; if this fails - or if the file isn't
+ * a regular file - the content is read into the C heap.
+ * the file position isn't changed.
+ * path: name of the file; if not NULL and -Xr is set, the content
+ * may have been read by the read-ahead thread already.
+ */
+static struct src_buffer *LoadSrcBuffer( FILE *file, const char *path )
+/*********************************************************************/
+{
+    struct src_buffer *sb;
+    char *p;
+    char *p2;
+    long size;
+    size_t max;
+    size_t cnt;
+
+    sb = MemAlloc( sizeof( struct src_buffer ) );
+    memset( sb, 0, sizeof( struct src_buffer ) );
+#if defined(__UNIX__) && defined(__GNUC__)
+    {
+        struct stat st;
+        int fd = fileno( file );
+#if PREFETCH
+        if ( path && fstat( fd, &st ) == 0 && ( p = PrefetchGet( path, &st, &cnt ) ) ) {
+            sb->base = p;
+            sb->end = p + cnt;
+            sb->size = cnt;
+            sb->mapped = FALSE;
+            return( sb );
+        }
+#endif
+        if ( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) && st.st_size > 0 ) {
+            p = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if ( p != MAP_FAILED ) {
+                sb->base = p;
+                sb->end = p + st.st_size;
+                sb->size = st.st_size;
+                sb->mapped = TRUE;
+                DebugMsg1(("LoadSrcBuffer: file mapped, size=%u\n", (unsigned)st.st_size ));
+                return( sb );
+            }
+        }
+    }
+#endif
+    sb->mapped = FALSE;
+    /* the size is just a hint; if it's unknown, the buffer grows while reading */
+    fseek( file, 0, SEEK_END );
+    size = ftell( file );
+    rewind( file );
+    max = ( size > 0 ? size : 0x8000 );
+    p = MemAlloc( max );
+    for ( cnt = 0; ; ) {
+        cnt += fread( p + cnt, 1, max - cnt, file );
+        if ( cnt < max )
+            break;
+        p2 = MemAlloc( max * 2 );
+        memcpy( p2, p, max );
+        MemFree( p );
+        p = p2;
+        max *= 2;
+    }
+    rewind( file );
+    sb->base = p;
+    sb->end = p + cnt;
+    sb->size = max;
+    DebugMsg1(("LoadSrcBuffer: file read, size=%u\n", cnt ));
+    return( sb );
+}
+
+static void FreeSrcBuffer( struct src_buffer *sb )
+/************************************************/
+{
+#if defined(__UNIX__) && defined(__GNUC__)
+    if ( sb->mapped )
+        munmap( (void *)sb->base, sb->size );
+    else
+#endif
+        MemFree( (void *)sb->base );
+#if INCCACHE
+    if ( sb->fname )
+        MemFree( sb->fname );
+#endif
+    MemFree( sb );
+}
+
+/* get the content of an include file.
+ * if INCCACHE is on, the cache is scanned first; the item is reused
+ * if path, modification time and size of the file match.
+ */
+static struct src_buffer *GetIncBuffer( FILE *file, const char *path )
+/********************************************************************/
+{
+#if INCCACHE
+    struct src_buffer *sb;
+    struct src_buffer **psb;
+    struct _stat st;
+
+    if ( _fstat( _fileno( file ), &st ) == 0 ) {
+        for ( psb = &SrcCache; *psb; psb = &(*psb)->next ) {
+            sb = *psb;
+            if ( filecmp( sb->fname, path ) == 0 ) {
+                if ( sb->mtime == st.st_mtime && sb->fsize == st.st_size
+#if SERVERSUPP
+                    && sb->dev == st.st_dev && sb->ino == st.st_ino
+#endif
+                   ) {
+                    DebugMsg1(("GetIncBuffer(%s): found in cache\n", path ));
+                    sb->refcnt++;
+                    return( sb );
+                }
+                /* file has been modified, remove the item from the cache */
+                *psb = sb->next;
+                sb->cached = FALSE;
+                if ( sb->refcnt == 0 )
+                    FreeSrcBuffer( sb );
+                break;
+            }
+        }
+        sb = LoadSrcBuffer( file, path );
+        sb->fname = MemAlloc( strlen( path ) + 1 );
+        strcpy( sb->fname, path );
+        sb->mtime = st.st_mtime;
+        sb->fsize = st.st_size;
+#if SERVERSUPP
+        sb->dev = st.st_dev;
+        sb->ino = st.st_ino;
+#endif
+        sb->cached = TRUE;
+        sb->refcnt = 1;
+        sb->next = SrcCache;
+        SrcCache = sb;
+        return( sb );
+    }
+#endif
+    return( LoadSrcBuffer( file, path ) );
+}
+
+/* release the content of an include file */
+
+static void ReleaseIncBuffer( struct src_buffer *sb )
+/***************************************************/
+{
+#if INCCACHE
+    if ( sb->refcnt ) {
+        sb->refcnt--;
+        if ( sb->refcnt || sb->cached )
+            return;
+    }
+#endif
+    FreeSrcBuffer( sb );
+}
+
+#if FORKSUPP
+
+/* v2.21: -jf: check if a source file contains a word ( case-insensitive ).
+ * Returns TRUE if the file cannot be read.
+ */
+bool FileHasWord( const char *name, const char *word )
+/****************************************************/
+{
+    FILE *file;
+    struct src_buffer *sb;
+    const char *p;
+    int len = strlen( word );
+    bool rc = FALSE;
+
+    if ( ( file = fopen( name, "rb" ) ) == NULL )
+        return( TRUE );
+    sb = GetIncBuffer( file, name );
+    for ( p = sb->base; p + len <= sb->end; p++ )
+        if ( _memicmp( p, word, len ) == 0 &&
+            ( p == sb->base || !is_valid_id_char( *(p-1) ) ) &&
+            ( p + len == sb->end || !is_valid_id_char( *(p+len) ) ) ) {
+            rc = TRUE;
+            break;
+        }
+    ReleaseIncBuffer( sb );
+    fclose( file );
+    return( rc );
+}
+
+/* v2.21: -jf: replace the main source file, which is the item at
+ * the bottom of the source stack. See RetargetModule().
+ */
+void SetMainSrcFile( void )
+/*************************/
+{
+    struct src_item *fl;
+    struct fname_item *fn;
+
+    for ( fl = src_stack; fl->next; fl = fl->next );
+    FreeSrcBuffer( fl->sb );
+    fl->file = CurrFile[ASM];
+    fl->sb = LoadSrcBuffer( CurrFile[ASM], NULL );
+    fl->curr = fl->sb->base;
+    fn = &ModuleInfo.g.FNames[fl->srcfile];
+    LclFree( fn->fname );
+    fn->fname = LclAlloc( strlen( CurrFName[ASM] ) + 1 );
+    strcpy( fn->fname, CurrFName[ASM] );
+    FileCur->string_ptr = fn->fname;
+}
+
+#endif
+
 /* clear input source stack (include files and open macros).
  * This is done after each pass.
  * Usually the stack is empty when the END directive occurs,
@@ -290,6 +596,7 @@ void ClearSrcStack( void )
     for( ; src_stack->next ; src_stack = nextfile ) {
         nextfile = src_stack->next;
         if ( src_stack->type == SIT_FILE ) {
+            ReleaseIncBuffer( src_stack->sb );
             fclose( src_stack->file );
         }
         //LclFree( src_stack );
@@ -349,45 +656,74 @@ char *GetTopSrcName( void )
  * returns NULL if EOF has been detected and no char stored in buffer
  * v2.08: 00 in the stream no longer causes an exit. Hence if the
  * char occurs in the comment part, everything is ok.
+ * v2.21: reads from the file's memory buffer, the end of the line is
+ * searched with memchr(). The behavior of the former getc()-based
+ * version is kept: CRs are skipped, Ctrl-Z terminates the line and
+ * if a line is too long, the char behind the max. length is lost.
  */
-static char *my_fgets( char *buffer, int max, FILE *fp )
-/******************************************************/
+static char *my_fgets( char *buffer, int max, struct src_item *fl )
+/*****************************************************************/
 {
+    const char  *p = fl->curr;
+    const char  *end = fl->sb->end;
+    const char  *eol;
+    const char  *cr;
     char        *ptr = buffer;
     char        *last = buffer + max;
-    int         c;
-
-    c = getc( fp );
-    while( ptr < last ) {
-        switch ( c ) {
-        case '\r':
-            break; /* don't store CR */
-        case '\n':
-            /* fall through */
-        //case '\0': /* v2.08: */
-#ifdef DEBUG_OUT
-            if ( Parse_Pass == PASS_1 )
-                cntflines++;
-#endif
-            *ptr = NULLC;
-            return( buffer );
+    size_t      len;
+
+    /* v2.21: buffer is cleared at EOF, as fgets() did it */
+    if ( p >= end ) {
+        *buffer = NULLC;
+        return( NULL );
+    }
+
+    eol = memchr( p, '\n', end - p );
+    if ( eol == NULL )
+        eol = end;
 #if DETECTCTRLZ
-        case 0x1a:
-            /* since source files are opened in binary mode, ctrl-z
-             * handling must be done here.
-             */
-            /* no break */
+    /* since source files are opened in binary mode, ctrl-z
+     * handling must be done here.
+     */
+    if ( cr = memchr( p, 0x1a, eol - p ) )
+        eol = cr;
 #endif
-        case EOF:
-            *ptr = NULLC;
-            return( ptr > buffer ? buffer : NULL );
-        default:
-            *ptr++ = c;
+    /* copy the line, skip CRs */
+    while ( p < eol ) {
+        if ( ( cr = memchr( p, '\r', eol - p ) ) == NULL )
+            cr = eol;
+        len = cr - p;
+        if ( len >= last - ptr ) {
+            len = last - ptr;
+            memcpy( ptr, p, len );
+            p += len;
+            if ( p < end ) /* the next char has been read already */
+                p++;
+            fl->curr = p;
+            EmitErr( LINE_TOO_LONG );
+            *(last-1) = NULLC;
+            return( buffer );
         }
-        c = getc( fp );
+        memcpy( ptr, p, len );
+        ptr += len;
+        p = cr;
+        if ( p < eol ) /* skip CR */
+            p++;
+    }
+    *ptr = NULLC;
+    if ( eol == end ) {
+        fl->curr = end;
+        return( ptr > buffer ? buffer : NULL );
     }
-    EmitErr( LINE_TOO_LONG );
-    *(ptr-1) = NULLC;
+    fl->curr = eol + 1;
+#if DETECTCTRLZ
+    if ( *eol == 0x1a )
+        return( ptr > buffer ? buffer : NULL );
+#endif
+#ifdef DEBUG_OUT
+    if ( Parse_Pass == PASS_1 )
+        cntflines++;
+#endif
     return( buffer );
 }
 
@@ -532,6 +868,320 @@ void print_source_nesting_structure( void )
     PrintNote( NOTE_MAIN_LINE_CODE, tab, "", GetFName( curr->srcfile )->fname, curr->line_num );
 }
 
+#if PATHCACHE || INCGUARD
+
+static unsigned pathhash( const char *s, int len )
+/************************************************/
+{
+    unsigned h;
+
+    for( h = 0; len; len--, s++ )
+        h = h * 31 + (unsigned char)*s;
+    return( h );
+}
+
+#endif
+
+#if PATHCACHE
+
+static struct path_item *FindPath( struct path_item **table, unsigned size, const char *path, int len )
+/****************************************************************************************************/
+{
+    struct path_item *pi;
+
+    for ( pi = table[pathhash( path, len ) % size]; pi; pi = pi->next )
+        if ( memcmp( pi->name, path, len ) == 0 && pi->name[len] == NULLC )
+            return( pi );
+    return( NULL );
+}
+
+static void AddPath( struct path_item **table, unsigned size, const char *path, int len )
+/***************************************************************************************/
+{
+    struct path_item *pi;
+    unsigned h = pathhash( path, len ) % size;
+
+    pi = MemAlloc( sizeof( struct path_item ) + len );
+    memcpy( pi->name, path, len );
+    pi->name[len] = NULLC;
+    pi->next = table[h];
+    table[h] = pi;
+}
+
+static void FreePaths( struct path_item **table, unsigned size )
+/**************************************************************/
+{
+    struct path_item *pi;
+    struct path_item *next;
+
+    for ( ; size; size--, table++ ) {
+        for ( pi = *table; pi; pi = next ) {
+            next = pi->next;
+            MemFree( pi );
+        }
+        *table = NULL;
+    }
+}
+
+#if defined(__UNIX__)
+
+/* read a directory and store its entries in table Found[].
+ * <dir> is either empty ( current directory ) or ends with a '/'.
+ * the directory's name is stored in table DirsRead[] - even
+ * if it couldn't be read; then all paths in it are "not found".
+ */
+static void ReadDir( const char *dir, int len )
+/*********************************************/
+{
+    DIR *pdir;
+    struct dirent *ent;
+    int entlen;
+    char path[FILENAME_MAX];
+
+    AddPath( DirsRead, PC_DIRS_SIZE, dir, len );
+    memcpy( path, dir, len );
+    path[len] = NULLC;
+    pdir = opendir( len ? path : "." );
+    DebugMsg1(("ReadDir(%s)=%p\n", path, pdir ));
+    if ( pdir == NULL )
+        return;
+    while ( ent = readdir( pdir ) ) {
+        entlen = strlen( ent->d_name );
+        if ( len + entlen < FILENAME_MAX ) {
+            memcpy( path + len, ent->d_name, entlen );
+            AddPath( Found, PC_FOUND_SIZE, path, len + entlen );
+        }
+    }
+    closedir( pdir );
+}
+#endif
+
+#endif
+
+/* open a source file.
+ * v2.21: if PATHCACHE is on, paths that weren't found before
+ * aren't tried again.
+ */
+static FILE *open_src_file( const char *path )
+/********************************************/
+{
+    FILE *file;
+#if PATHCACHE
+    int len = strlen( path );
+
+    if ( FindPath( NotFound, PC_NOTFOUND_SIZE, path, len ) ) {
+        errno = ENOENT;
+        return( NULL );
+    }
+#if defined(__UNIX__)
+    if ( Options.cache_incdirs ) {
+        int dirlen = GetFNamePart( path ) - path;
+        if ( FindPath( DirsRead, PC_DIRS_SIZE, path, dirlen ) == NULL )
+            ReadDir( path, dirlen );
+        if ( FindPath( Found, PC_FOUND_SIZE, path, len ) == NULL ) {
+            errno = ENOENT;
+            return( NULL );
+        }
+    }
+#endif
+#endif
+    file = fopen( path, "rb" );
+#if PATHCACHE
+    if ( file == NULL && errno == ENOENT )
+        AddPath( NotFound, PC_NOTFOUND_SIZE, path, len );
+#endif
+    return( file );
+}
+
+#if INCGUARD
+
+/* v2.21: item of table IncNames[]. It maps the name argument of
+ * INCLUDE to the index of the file in ModuleInfo.g.FNames. Since the
+ * directory of the current source is searched first, it's part of the key.
+ */
+struct inc_name {
+    struct inc_name     *next;
+    uint_16             srcfile;    /* index in ModuleInfo.g.FNames */
+    uint_16             dirlen;     /* size of directory part of name */
+    char                name[1];    /* directory of current source + name */
+};
+
+#define INCNAME_SIZE 256
+
+static struct inc_name *IncNames[INCNAME_SIZE]; /* table is reset for each module */
+
+static unsigned incnamehash( const char *dir, int dirlen, const char *name )
+/**************************************************************************/
+{
+    return( ( pathhash( dir, dirlen ) * 31 + pathhash( name, strlen( name ) ) ) % INCNAME_SIZE );
+}
+
+static struct inc_name *FindIncName( const char *dir, int dirlen, const char *name )
+/**********************************************************************************/
+{
+    struct inc_name *in;
+
+    for ( in = IncNames[incnamehash( dir, dirlen, name )]; in; in = in->next )
+        if ( in->dirlen == dirlen && memcmp( in->name, dir, dirlen ) == 0 && strcmp( in->name + dirlen, name ) == 0 )
+            return( in );
+    return( NULL );
+}
+
+static void AddIncName( const char *dir, int dirlen, const char *name, unsigned srcfile )
+/**************************************************************************************/
+{
+    struct inc_name *in;
+    unsigned h = incnamehash( dir, dirlen, name );
+
+    in = LclAlloc( sizeof( struct inc_name ) + dirlen + strlen( name ) );
+    in->srcfile = srcfile;
+    in->dirlen = dirlen;
+    memcpy( in->name, dir, dirlen );
+    strcpy( in->name + dirlen, name );
+    in->next = IncNames[h];
+    IncNames[h] = in;
+}
+
+/* is the rest of the line empty or a comment? */
+
+static bool IsLineEnd( const char *p, const char *eol )
+/*****************************************************/
+{
+    while ( p < eol && isspace( *p ) )
+        p++;
+    return( p == eol || *p == ';' );
+}
+
+/* scan the content of an include file for a multiple-include guard:
+ *   IFNDEF <symbol>
+ *   ...
+ *   ENDIF
+ * outside of this block, just empty lines and comments are accepted.
+ * The block itself is scanned like Tokenize() does it for inactive
+ * conditional blocks: just the first item of a line is checked.
+ * returns the symbol's name or "" if there's no guard.
+ */
+static char *GetIncGuard( const char *p, const char *end )
+/********************************************************/
+{
+    enum { GS_START, GS_BLOCK, GS_END } state = GS_START;
+    const char  *eol;
+    const char  *word;
+    const char  *guard;
+    int         len;
+    int         guardlen;
+    int         level = 0;
+    char        *name;
+
+    /* ctrl-z and overlong lines would need the full line scanner */
+    if ( memchr( p, 0x1a, end - p ) )
+        return( "" );
+    for ( ; p < end; p = eol + 1 ) {
+        if ( ( eol = memchr( p, '\n', end - p ) ) == NULL )
+            eol = end;
+        if ( eol - p >= MAX_LINE_LEN - 1 )
+            return( "" );
+        if ( IsLineEnd( p, eol ) )
+            continue;
+        if ( state == GS_END )
+            return( "" );
+        while ( isspace( *p ) )
+            p++;
+        for ( word = p; p < eol && is_valid_id_char( *p ); p++ );
+        len = p - word;
+        if ( len == 0 || len > MAX_ID_LEN ) {
+            if ( state == GS_START )
+                return( "" );
+            continue;
+        }
+        switch ( FindResWord( word, len ) ) {
+        case T_IFNDEF:
+            if ( state == GS_START ) {
+                while ( p < eol && isspace( *p ) )
+                    p++;
+                for ( guard = p; p < eol && is_valid_id_char( *p ); p++ );
+                guardlen = p - guard;
+                if ( guardlen == 0 || guardlen > MAX_ID_LEN || isdigit( *guard ) ||
+                    FindResWord( guard, guardlen ) || !IsLineEnd( p, eol ) )
+                    return( "" );
+                state = GS_BLOCK;
+                continue;
+            }
+            /* no break */
+        case T_IF:
+        case T_IF1:
+        case T_IF2:
+        case T_IFB:
+        case T_IFDEF:
+        case T_IFDIF:
+        case T_IFDIFI:
+        case T_IFE:
+        case T_IFIDN:
+        case T_IFIDNI:
+        case T_IFNB:
+            level++;
+            break;
+        case T_ELSE:
+        case T_ELSEIF:
+        case T_ELSEIF1:
+        case T_ELSEIF2:
+        case T_ELSEIFB:
+        case T_ELSEIFDEF:
+        case T_ELSEIFDIF:
+        case T_ELSEIFDIFI:
+        case T_ELSEIFE:
+        case T_ELSEIFIDN:
+        case T_ELSEIFIDNI:
+        case T_ELSEIFNB:
+        case T_ELSEIFNDEF:
+            if ( level == 0 )
+                return( "" );
+            break;
+        case T_ENDIF:
+            if ( level == 0 ) {
+                if ( !IsLineEnd( p, eol ) )
+                    return( "" );
+                state = GS_END;
+                continue;
+            }
+            level--;
+            break;
+        case T_COMMENT:
+            return( "" );
+        }
+        if ( state == GS_START )
+            return( "" );
+    }
+    if ( state != GS_END )
+        return( "" );
+    name = LclAlloc( guardlen + 1 );
+    memcpy( name, guard, guardlen );
+    name[guardlen] = NULLC;
+    DebugMsg1(("GetIncGuard: guard symbol %s found\n", name ));
+    return( name );
+}
+
+/* check if an include file can be skipped: its guard symbol
+ * must be defined, which is the condition that IFNDEF checks.
+ * not done if a listing or preprocessed output is written, since
+ * the skipped lines may appear there.
+ * Note: keywords renamed or disabled after the guard has been
+ * detected aren't considered.
+ */
+static bool IsIncGuarded( unsigned srcfile )
+/******************************************/
+{
+    struct asym *sym;
+    const char *guard = ModuleInfo.g.FNames[srcfile].guard;
+
+    if ( guard == NULL || *guard == NULLC || ModuleInfo.list || Options.preprocessor_stdout )
+        return( FALSE );
+    sym = SymSearch( guard );
+    return( sym && sym->isdefined );
+}
+
+#endif
+
 /* Scan the include path for a file!
  * variable ModuleInfo.g.IncludePath also contains directories set with -I cmdline option.
  */
@@ -579,7 +1229,7 @@ static FILE *open_file_in_include_path( const char *name, char fullpath[] )
         strcpy( fullpath+i, name );
 
         DebugMsg(("open_file_in_include_path: >%s<\n", fullpath ));
-        file = fopen( fullpath, "rb" );
+        file = open_src_file( fullpath );
         if( file ) {
             break;
         }
@@ -588,6 +1238,144 @@ static FILE *open_file_in_include_path( const char *name, char fullpath[] )
     return( file );
 }
 
+#if PREFETCH
+
+/* v2.21: -Xr: queue a file for the read-ahead thread. The paths are
+ * the ones that SearchFile() tries: the directory of the including
+ * file, the current directory and the include path.
+ * Files in the include file cache aren't read again.
+ */
+static void QueuePrefetch( const char *dir, int dirlen, const char *name, int namelen, bool binary )
+/*************************************************************************************************/
+{
+    char        *paths;
+    char        *p;
+    const char  *curr;
+    const char  *next;
+    int         i;
+    unsigned    max;
+    bool        isabs = ISABS( name );
+#if INCCACHE
+    struct src_buffer *sb;
+#endif
+
+    if ( namelen == 0 || namelen >= FILENAME_MAX )
+        return;
+    max = dirlen + 2 * ( namelen + 1 );
+    if ( ModuleInfo.g.IncludePath ) {
+        for ( curr = ModuleInfo.g.IncludePath, i = 1; *curr; curr++ )
+            if ( *curr == INC_PATH_DELIM )
+                i++;
+        max += ( curr - ModuleInfo.g.IncludePath ) + i * ( namelen + 2 );
+    }
+    p = paths = MemAlloc( max );
+    if ( dirlen && !isabs ) {
+        memcpy( p, dir, dirlen );
+        p += dirlen;
+        memcpy( p, name, namelen );
+        p += namelen;
+        *p++ = NULLC;
+    }
+    memcpy( p, name, namelen );
+    p += namelen;
+    *p++ = NULLC;
+    for ( curr = ( isabs ? NULL : ModuleInfo.g.IncludePath ); curr; curr = next ) {
+        if ( next = strchr( curr, INC_PATH_DELIM ) ) {
+            i = next - curr;
+            next++;
+        } else
+            i = strlen( curr );
+        if ( i == 0 || ( ( i + namelen ) >= FILENAME_MAX ) )
+            continue;
+        memcpy( p, curr, i );
+        if( p[i-1] != '/'
+#if !defined(__UNIX__)
+           && p[i-1] != '\\' && p[i-1] != ':'
+#endif
+        ) {
+            p[i] = DIR_SEPARATOR;
+            i++;
+        }
+        memcpy( p + i, name, namelen );
+        p += i + namelen;
+        *p++ = NULLC;
+    }
+#if INCCACHE
+    if ( !binary )
+        for ( curr = paths; curr < p; curr += strlen( curr ) + 1 )
+            for ( sb = SrcCache; sb; sb = sb->next )
+                if ( filecmp( sb->fname, curr ) == 0 ) {
+                    MemFree( paths );
+                    return;
+                }
+#endif
+    PrefetchFile( paths, p - paths, binary );
+    MemFree( paths );
+}
+
+/* v2.21: -Xr: scan the content of a source file for INCLUDE and INCBIN
+ * directives and queue the files. Like in GetIncGuard(), just the first
+ * item of a line is checked. The argument is used literally, without
+ * text macro expansion; if it's wrong, the read-ahead is just wasted.
+ */
+static void PrefetchIncludes( const struct src_buffer *sb, const char *path )
+/***************************************************************************/
+{
+    const char  *p;
+    const char  *end = sb->end;
+    const char  *eol;
+    const char  *word;
+    const char  *name;
+    int         dirlen = GetFNamePart( path ) - path;
+    int         len;
+    int         token;
+    char        delim;
+
+    for ( p = sb->base; p < end; p = eol + 1 ) {
+        if ( ( eol = memchr( p, '\n', end - p ) ) == NULL )
+            eol = end;
+        while ( p < eol && isspace( *p ) )
+            p++;
+        for ( word = p; p < eol && is_valid_id_char( *p ); p++ );
+        len = p - word;
+        if ( len == 0 || len > MAX_ID_LEN )
+            continue;
+        token = FindResWord( word, len );
+        if ( token != T_INCLUDE && token != T_INCBIN )
+            continue;
+        while ( p < eol && isspace( *p ) )
+            p++;
+        if ( p < eol && ( *p == '<' || ( token == T_INCBIN && ( *p == '"' || *p == '\'' ) ) ) ) {
+            delim = ( *p == '<' ? '>' : *p );
+            for ( name = ++p; p < eol && *p != delim; p++ );
+            if ( p == eol )
+                continue;
+        } else if ( token == T_INCLUDE ) {
+            for ( name = p; p < eol && *p != ';'; p++ );
+            while ( p > name && isspace( *(p-1) ) )
+                p--;
+        } else
+            continue;
+        QueuePrefetch( path, dirlen, name, p - name, token == T_INCBIN );
+    }
+}
+
+/* v2.21: -Xr: queue the -Fi files and the files included by the main
+ * source. Called at the start of pass one, when the include path is known.
+ */
+void InputPrefetch( struct qitem *pq )
+/************************************/
+{
+    const char *src = GetFName( ModuleInfo.srcfile )->fname;
+    int dirlen = GetFNamePart( src ) - src;
+
+    for ( ; pq; pq = pq->next )
+        QueuePrefetch( src, dirlen, pq->value, strlen( pq->value ), FALSE );
+    PrefetchIncludes( src_stack->sb, src );
+}
+
+#endif
+
 /* the worker behind the INCLUDE directive. Also used
  * by INCBIN and the -Fi cmdline option.
  * the main source file is added in InputInit().
@@ -601,6 +1389,12 @@ FILE *SearchFile( const char *path, bool queue )
     struct src_item *fl;
     const char  *fn;
     bool        isabs;
+#if INCGUARD
+    const char  *name = path;
+    const char  *dir = "";
+    int         dirlen = 0;
+    struct inc_name *in = NULL;
+#endif
     char        fullpath[FILENAME_MAX];
 
     DebugMsg1(("SearchFile(%s) enter\n", path ));
@@ -615,6 +1409,23 @@ FILE *SearchFile( const char *path, bool queue )
      */
 
     isabs = ISABS( path );
+#if INCGUARD
+    /* v2.21: if the file has been included before and has a guard
+     * that is active, skip it.
+     */
+    if ( queue ) {
+        if ( !isabs ) {
+            for ( fl = src_stack; fl->type != SIT_FILE; fl = fl->next );
+            dir = GetFName( fl->srcfile )->fname;
+            dirlen = GetFNamePart( dir ) - dir;
+        }
+        in = FindIncName( dir, dirlen, name );
+        if ( in && IsIncGuarded( in->srcfile ) ) {
+            DebugMsg1(("SearchFile(%s): skipped, guard %s is defined\n", path, ModuleInfo.g.FNames[in->srcfile].guard ));
+            return( NULL );
+        }
+    }
+#endif
     //if ( dir[0] != '\\' && dir[0] != '/' ) {
     if ( !isabs ) {
         for ( fl = src_stack; fl ; fl = fl->next ) {
@@ -633,7 +1444,7 @@ FILE *SearchFile( const char *path, bool queue )
                      */
                     memcpy( fullpath, src, i );
                     strcpy( fullpath + i, path );
-                    if ( file = fopen( fullpath, "rb" ) ) {
+                    if ( file = open_src_file( fullpath ) ) {
                         DebugMsg1(("SearchFile(): file found, fopen(%s)=%X\n", fullpath, file ));
                         path = fullpath;
                     }
@@ -648,7 +1459,7 @@ FILE *SearchFile( const char *path, bool queue )
     }
     if ( file == NULL ) {
         fullpath[0] = NULLC;
-        file = fopen( path, "rb" );
+        file = open_src_file( path );
         DebugMsg1(("SearchFile(): fopen(%s)=%X\n", path, file ));
 
         /* if the file isn't found yet and include paths have been set,
@@ -674,13 +1485,29 @@ FILE *SearchFile( const char *path, bool queue )
      */
     if ( queue ) {
         fl = PushSrcItem( SIT_FILE, file );
+        fl->sb = GetIncBuffer( file, path );
+        fl->curr = fl->sb->base;
         fl->srcfile = AddFile( path );
         FileCur->string_ptr = GetFName( fl->srcfile )->fname;
+#if PREFETCH
+        if ( Options.read_ahead && Parse_Pass == PASS_1 )
+            PrefetchIncludes( fl->sb, path );
+#endif
+#if INCGUARD
+        if ( ModuleInfo.g.FNames[fl->srcfile].guard == NULL )
+            ModuleInfo.g.FNames[fl->srcfile].guard = GetIncGuard( fl->sb->base, fl->sb->end );
+        if ( in == NULL )
+            AddIncName( dir, dirlen, name, fl->srcfile );
+#endif
 #if FILESEQ
         if ( Options.line_numbers && Parse_Pass == PASS_1 )
             AddFileSeq( fl->srcfile );
 #endif
     }
+#if OBJCACHE
+    else
+        ObjCacheAddFile( path ); /* v2.21: INCBIN file */
+#endif
     return( file );
 }
 
@@ -698,7 +1525,7 @@ char *GetTextLine( char *buffer )
 
     if ( curr->type == SIT_FILE ) {
 
-        if( my_fgets( buffer, MAX_LINE_LEN, curr->file ) ) {
+        if( my_fgets( buffer, MAX_LINE_LEN, curr ) ) {
             curr->line_num++;
 #ifdef DEBUG_OUT
             if ( Parse_Pass == PASS_1 ) cntlines++;
@@ -709,6 +1536,7 @@ char *GetTextLine( char *buffer )
         DebugMsg1(("GetTextLine: ***** EOF file %s (idx=%u) *****\n", GetFName( curr->srcfile )->fname, curr->srcfile ));
         /* don't close and remove main source file */
         if ( curr->next ) {
+            ReleaseIncBuffer( curr->sb );
             fclose( curr->file );
             src_stack = curr->next;
             curr->next = SrcFree;
@@ -749,6 +1577,67 @@ char *GetTextLine( char *buffer )
     return( NULL ); /* end of file or macro reached */
 }
 
+#if SKIPSCAN
+
+/* v2.21: skip lines of an inactive conditional assembly block.
+ * In such a block Tokenize() checks the first item of a line only,
+ * for a conditional assembly directive. This is done here on the
+ * file content, without copying the line and creating tokens.
+ * The scan stops at the next line that may contain such a directive
+ * ( this line is then read by GetTextLine() ) or that might need the
+ * full line scanner: overlong lines, ctrl-z, a backslash behind the
+ * first name ( line concatenation ) or an unusual first character.
+ */
+void SkipFalseLines( void )
+/*************************/
+{
+    struct src_item *curr = src_stack;
+    const char  *p;
+    const char  *end;
+    const char  *eol;
+    const char  *word;
+    int         i;
+
+    if ( curr->type != SIT_FILE )
+        return;
+    end = curr->sb->end;
+    for ( ; curr->curr < end; curr->curr = eol + 1 ) {
+        p = curr->curr;
+        if ( ( eol = memchr( p, '\n', end - p ) ) == NULL || eol - p >= MAX_LINE_LEN - 1 )
+            break;
+#if DETECTCTRLZ
+        if ( memchr( p, 0x1a, eol - p ) )
+            break;
+#endif
+        while ( p < eol && isspace( *p ) )
+            p++;
+        if ( p < eol && *p != ';' ) {
+            if ( !( is_valid_id_char( *p ) && !isdigit( *p ) ) &&
+                !( *p == '.' && is_valid_id_char( *(p+1) ) ) )
+                break;
+            for ( word = p++; is_valid_id_char( *p ); p++ );
+            /* a '.' may continue the name ( OPTION DOTNAME ); CRs are removed by my_fgets() */
+            if ( *p == '\\' || *p == '.' || ( *p == '\r' && *(p+1) != '\n' ) || p - word > MAX_ID_LEN )
+                break;
+            i = FindResWord( word, p - word );
+            if ( i && i < SPECIAL_LAST && SpecialTable[i].type == RWT_DIRECTIVE &&
+                SpecialTable[i].bytval == DRT_CONDDIR )
+                break;
+        }
+        curr->line_num++;
+        /* the line variables are set as PreprocessLine() does it */
+        ModuleInfo.CurrComment = NULL;
+        ModuleInfo.line_flags = 0;
+        Token_Count = 0;
+#ifdef DEBUG_OUT
+        if ( Parse_Pass == PASS_1 ) cntslines++;
+#endif
+    }
+    return;
+}
+
+#endif
+
 /* add a string to the include path.
  * called for -I cmdline options.
  * the include path is rebuilt for each assembled module.
@@ -906,6 +1795,9 @@ void InputInit( void )
     //IncludePath = NULL;
     //src_stack = NULL;
     SrcFree = NULL; /* v2.11 */
+#if INCGUARD
+    memset( IncNames, 0, sizeof( IncNames ) );
+#endif
 #if FILESEQ
     FileSeq.head = NULL;
 #endif
@@ -917,6 +1809,9 @@ void InputInit( void )
     cnttok1 = 0;
     cntflines = 0;
     cntlines = 0;
+#if SKIPSCAN
+    cntslines = 0;
+#endif
 #endif
 
     /* add path of main module to the include path.
@@ -942,6 +1837,7 @@ void InputInit( void )
 #endif
 
     fl = PushSrcItem( SIT_FILE, CurrFile[ASM] );
+    fl->sb = LoadSrcBuffer( CurrFile[ASM], CurrFName[ASM] );
     fl->srcfile = ModuleInfo.srcfile = AddFile( CurrFName[ASM] );
     /* setting a function pointer won't work for text macros! */
     //FileCur->sfunc_ptr = &GetFileCur;
@@ -957,6 +1853,7 @@ void InputPassInit( void )
 {
     DebugMsg(( "InputPassInit() enter\n" ));
     src_stack->line_num = 0;
+    src_stack->curr = src_stack->sb->base; /* v2.21: replaces rewind() of the main source */
     //inside_comment = NULLC;
     CurrSource = srclinebuffer;
     *CurrSource = NULLC;
@@ -988,6 +1885,14 @@ void InputFini( void )
         DebugMsg(( "InputFini: idx=%u name=%s\n", i, ModuleInfo.g.FNames[i].fname ));
     }
 #endif
+#if PREFETCH
+    PrefetchFini(); /* v2.21: stop the read-ahead thread */
+#endif
+    /* v2.21: release content of main source file */
+    if ( src_stack && src_stack->sb ) {
+        FreeSrcBuffer( src_stack->sb );
+        src_stack->sb = NULL;
+    }
     if ( ModuleInfo.g.IncludePath )
         MemFree( ModuleInfo.g.IncludePath );
 
@@ -996,6 +1901,9 @@ void InputFini( void )
 #ifdef DEBUG_OUT
     if ( Options.quiet == FALSE ) {
         printf("lines read(files)/processed in pass one: %" I32_SPEC "u / %" I32_SPEC "u\n", cntflines, cntlines );
+#if SKIPSCAN
+        printf("lines skipped in inactive blocks: %" I32_SPEC "u\n", cntslines );
+#endif
         printf("invokations: PreprocessLine=%" I32_SPEC "u/%" I32_SPEC "u/%" I32_SPEC "u, Tokenize=%" I32_SPEC "u/%" I32_SPEC "u\n", cntppl0, cntppl1, cntppl2, cnttok0, cnttok1 );
     }
 #endif
@@ -1009,3 +1917,35 @@ void InputFini( void )
 #endif
     LclFree( srclinebuffer );
 }
+
+/* release the path caches; called at program exit and by the server for each job */
+
+void InputPathCacheFini( void )
+/*****************************/
+{
+#if PATHCACHE
+    FreePaths( NotFound, PC_NOTFOUND_SIZE );
+#if defined(__UNIX__)
+    FreePaths( DirsRead, PC_DIRS_SIZE );
+    FreePaths( Found, PC_FOUND_SIZE );
+#endif
+#endif
+    return;
+}
+
+/* release the include file and path caches; called once at program exit */
+
+void InputCacheFini( void )
+/*************************/
+{
+#if INCCACHE
+    struct src_buffer *sb;
+
+    for ( ; SrcCache; SrcCache = sb ) {
+        sb = SrcCache->next;
+        FreeSrcBuffer( SrcCache );
+    }
+#endif
+    InputPathCacheFini();
+    return;
+}
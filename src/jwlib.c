@@ -0,0 +1,211 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  libjwasm.so: assembles sources held in memory.
+*               Source, object module and messages are memory streams
+*               that AssembleModule() uses instead of named files
+*               ( see ExtFile[] in assemble.c ). Before each call, the
+*               options are reset to the values at the first call. The
+*               reserved words table and the include file cache are kept.
+*
+****************************************************************************/
+
+#define _GNU_SOURCE /* for fopencookie() */
+
+#include <pthread.h>
+
+#include "globals.h"
+#include "input.h"
+#include "cmdline.h"
+#include "server.h"
+#include "jwlib.h"
+
+#if SERVERSUPP
+
+#define DEFNAME "jwlib.asm" /* name of source if none is given */
+
+/* a memory stream. size may exceed max; then the bytes
+ * behind the buffer are lost.
+ */
+struct memfile {
+    char        *base;
+    size_t      max;   /* size of buffer */
+    size_t      size;  /* size of stream */
+    size_t      pos;   /* current position */
+};
+
+extern char     banner_printed;
+
+static struct global_options dfltoptions; /* options at the first call */
+static const char *modname;
+static bool     assembled; /* AssembleModule() has been called */
+
+static ssize_t MemRead( void *cookie, char *buffer, size_t size )
+/***************************************************************/
+{
+    struct memfile *mf = cookie;
+
+    if ( mf->pos >= mf->size )
+        return( 0 );
+    if ( size > mf->size - mf->pos )
+        size = mf->size - mf->pos;
+    memcpy( buffer, mf->base + mf->pos, size );
+    mf->pos += size;
+    return( size );
+}
+
+/* writes don't fail; the size of the stream is always known */
+
+static ssize_t MemWrite( void *cookie, const char *buffer, size_t size )
+/**********************************************************************/
+{
+    struct memfile *mf = cookie;
+    size_t start = mf->pos;
+    size_t end = mf->pos + size;
+
+    /* a gap created by fseek() is filled with zeros */
+    if ( start > mf->size && mf->size < mf->max )
+        memset( mf->base + mf->size, 0, ( start < mf->max ? start : mf->max ) - mf->size );
+    if ( start < mf->max )
+        memcpy( mf->base + start, buffer, ( end < mf->max ? end : mf->max ) - start );
+    mf->pos = end;
+    if ( end > mf->size )
+        mf->size = end;
+    return( size );
+}
+
+static int MemSeek( void *cookie, off64_t *offset, int whence )
+/*************************************************************/
+{
+    struct memfile *mf = cookie;
+    off64_t pos = *offset;
+
+    switch ( whence ) {
+    case SEEK_CUR: pos += mf->pos;  break;
+    case SEEK_END: pos += mf->size; break;
+    }
+    if ( pos < 0 )
+        return( -1 );
+    mf->pos = *offset = pos;
+    return( 0 );
+}
+
+/* the buffer belongs to the caller */
+
+static int MemClose( void *cookie )
+/*********************************/
+{
+    return( 0 );
+}
+
+static FILE *MemOpen( struct memfile *mf, const char *mode )
+/**********************************************************/
+{
+    static const cookie_io_functions_t iofuncs = { MemRead, MemWrite, MemSeek, MemClose };
+
+    return( fopencookie( mf, mode, iofuncs ) );
+}
+
+/* process the options and assemble the module; called by GuardedJob() */
+
+static int LibJob( char **argv )
+/******************************/
+{
+    int numArgs = 0;
+    int rc = JWLIB_FAILURE;
+
+    /* file names aren't accepted */
+    if ( ParseCmdline( (const char **)argv, &numArgs ) == NULL ) {
+        assembled = TRUE;
+        rc = ( AssembleModule( modname ) ? JWLIB_OK : JWLIB_ERRORS );
+    }
+    CmdlineFini();
+    return( rc );
+}
+
+int JWasmAssemble( const char *options, const char *name,
+                  const char *src, size_t srcsize,
+                  void *out, size_t *outsize,
+                  char *msgs, size_t *msgsize )
+/*************************************************************/
+{
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    static bool init = FALSE;
+    struct memfile mf[NUM_FILE_TYPES];
+    char *buffer;
+    char **argv;
+    char *p;
+    char *next;
+    int argc;
+    int rc;
+    int i;
+
+    if ( ( buffer = malloc( strlen( options ) + 1 ) ) == NULL ||
+        ( argv = malloc( ( strlen( options ) / 2 + 2 ) * sizeof( char * ) ) ) == NULL ) {
+        free( buffer );
+        return( JWLIB_FAILURE );
+    }
+    /* split options; ParseCmdline() expects one option per item */
+    strcpy( buffer, options );
+    for ( argc = 0, p = strtok_r( buffer, " \t\r\n", &next ); p; p = strtok_r( NULL, " \t\r\n", &next ) )
+        argv[argc++] = p;
+    argv[argc] = NULL;
+
+    pthread_mutex_lock( &mutex );
+
+    if ( init == FALSE ) {
+        memcpy( &dfltoptions, &Options, sizeof( Options ) );
+        init = TRUE;
+    }
+    memcpy( &Options, &dfltoptions, sizeof( Options ) );
+    /* messages are written to the ERR stream only */
+    Options.quiet = TRUE;
+    Options.no_error_disp = TRUE;
+    banner_printed = TRUE;
+    /* files may have been created or the current directory changed */
+    InputPathCacheFini();
+    modname = ( name ? name : DEFNAME );
+    assembled = FALSE;
+
+    memset( mf, 0, sizeof( mf ) );
+    mf[ASM].base = (char *)src;
+    mf[ASM].max = mf[ASM].size = srcsize;
+    mf[OBJ].base = out;
+    mf[OBJ].max = *outsize;
+    mf[ERR].base = msgs;
+    mf[ERR].max = ( *msgsize ? *msgsize - 1 : 0 );
+    ExtFile[ASM] = MemOpen( &mf[ASM], "r" );
+    ExtFile[OBJ] = MemOpen( &mf[OBJ], "w" );
+    ExtFile[ERR] = MemOpen( &mf[ERR], "w" );
+
+    if ( ExtFile[ASM] && ExtFile[OBJ] && ExtFile[ERR] ) {
+        rc = GuardedJob( LibJob, argv );
+        if ( assembled == FALSE )
+            rc = JWLIB_FAILURE;
+    } else
+        rc = JWLIB_FAILURE;
+
+    for ( i = 0; i < NUM_FILE_TYPES; i++ )
+        if ( ExtFile[i] ) {
+            fclose( ExtFile[i] );
+            ExtFile[i] = NULL;
+        }
+
+    pthread_mutex_unlock( &mutex );
+
+    if ( rc == JWLIB_OK && mf[OBJ].size > mf[OBJ].max )
+        rc = JWLIB_OVERFLOW;
+    *outsize = mf[OBJ].size;
+    if ( *msgsize )
+        msgs[mf[ERR].size < mf[ERR].max ? mf[ERR].size : mf[ERR].max] = NULLC;
+    *msgsize = mf[ERR].size;
+
+    free( argv );
+    free( buffer );
+    return( rc );
+}
+
+#endif
@@ -951,6 +951,7 @@ static void log_proc( const struct asym *sym )
     const char *p;
     struct dsym *dir = (struct dsym *)sym;
     int i = sym->name_size;
+    unsigned j;
     char Ofssize = GetSymOfssize( sym );
     const char *pdots;
 
@@ -1076,9 +1077,10 @@ static void log_proc( const struct asym *sym )
         }
 
         /* todo for v2.20: sort local labels */
-        for ( l = dir->e.procinfo->labellist; l ; l = l->e.nextll ) {
+        /* v2.21: scan the proc's local hash table */
+        for ( j = 0; dir->e.procinfo->localtab && j < LHASH_TABLE_SIZE; j++ ) {
             struct dsym *l2;
-            for ( l2 = l; l2; l2 = (struct dsym *)l2->sym.nextitem ) {
+            for ( l2 = (struct dsym *)dir->e.procinfo->localtab[j]; l2; l2 = (struct dsym *)l2->sym.nextitem ) {
                 /* filter params and locals! */
                 if ( l2->sym.state == SYM_STACK || l2->sym.state == SYM_TMACRO )
                     continue;
@@ -1220,6 +1222,7 @@ void LstWriteCRef( void )
     /* go to EOF */
     fseek( CurrFile[LST], 0, SEEK_END );
 
+    SymCompleteAll(); /* v2.21: compact equates and deferred PROTOs are listed as well */
     SymCount = SymGetCount();
     syms = MemAlloc( SymCount * sizeof( struct asym * ) );
     SymGetAll( syms );
@@ -15,6 +15,8 @@
 #include "msgtext.h"
 #include "cmdline.h"
 #include "input.h" /* GetFNamePart() */
+#include "server.h"
+#include "objcache.h"
 
 #if defined(__UNIX__) || defined(__CYGWIN__) || defined(__DJGPP__)
 
@@ -41,11 +43,414 @@
  #endif
 #endif
 
+#if defined(__UNIX__)
+#define PARALLEL 1 /* v2.21: support -j */
+#else
+#define PARALLEL 0
+#endif
+
+#if PARALLEL
+ #include <unistd.h>
+ #include <sys/wait.h>
+#endif
+
 #ifdef TRMEM
 void tm_Init( void );
 void tm_Fini( void );
 #endif
 
+#if PARALLEL
+
+/* v2.21: option -j. Each module is assembled by a worker process.
+ * The output of the workers is buffered in temporary files and
+ * written in the order of the modules on the command line.
+ */
+struct job {
+    pid_t   pid;
+    FILE    *out;   /* buffered stdout of worker */
+    FILE    *err;   /* buffered stderr of worker */
+    int     status; /* exit code of worker, -1 if still running */
+};
+
+static struct job *jobs;    /* all jobs in cmdline order */
+static unsigned cntjobs;    /* items in jobs[] */
+static unsigned maxjobs;    /* size of jobs[] */
+static unsigned firstjob;   /* first job whose output isn't written yet */
+static unsigned running;    /* number of running workers */
+static bool     jobfailed;  /* a worker has returned an error */
+
+#if FORKSUPP
+
+/* v2.21: option -jf. The first module that has -Fi files is the
+ * "template": it's assembled in this process until the -Fi files
+ * have been processed. Then a worker is forked for the template
+ * and for each following module with the same options; the workers
+ * continue with the state of the template, see ForkModules().
+ */
+enum tmpl_state {
+    TS_NONE,      /* no template active */
+    TS_PRELUDE,   /* template processes -Fi files, output is captured */
+    TS_WORKER,    /* a worker forked by the template */
+};
+
+static struct {
+    enum tmpl_state state;
+    bool        pending;   /* Options.names[ASM] is the next module */
+    bool        eoc;       /* end of cmdline reached */
+    const char  **argv;    /* cmdline, to continue ParseCmdline() */
+    int         *pnumArgs;
+    FILE        *out;      /* captured stdout of template */
+    FILE        *err;      /* captured stderr of template */
+    int         outfd;     /* saved stdout/stderr handles */
+    int         errfd;
+    struct global_options options;         /* options of template */
+    struct qitem          *tails[OPTQ_LAST]; /* last items of option queues */
+} tmpl;
+
+#endif
+
+/* append the content of temporary file <src> to <dst> */
+
+static void AppendOutput( FILE *src, FILE *dst )
+/**********************************************/
+{
+    char buffer[4096];
+    size_t size;
+
+    fflush( src );
+    rewind( src );
+    while ( ( size = fread( buffer, 1, sizeof( buffer ), src ) ) > 0 )
+        fwrite( buffer, 1, size, dst );
+    fflush( dst );
+}
+
+static void CopyOutput( FILE *src, FILE *dst )
+/********************************************/
+{
+    AppendOutput( src, dst );
+    fclose( src );
+}
+
+/* write the output of finished jobs, in cmdline order */
+
+static void FlushJobs( void )
+/***************************/
+{
+    for ( ; firstjob < cntjobs && jobs[firstjob].status != -1; firstjob++ ) {
+        CopyOutput( jobs[firstjob].out, stdout );
+        CopyOutput( jobs[firstjob].err, stderr );
+        if ( jobs[firstjob].status != 0 )
+            jobfailed = TRUE;
+    }
+}
+
+/* wait for a worker to terminate */
+
+static void WaitJob( void )
+/*************************/
+{
+    pid_t pid;
+    int status;
+    unsigned i;
+
+    if ( ( pid = wait( &status ) ) == -1 ) {
+        /* shouldn't happen; regard all running jobs as failed */
+        for ( i = firstjob; i < cntjobs; i++ )
+            if ( jobs[i].status == -1 )
+                jobs[i].status = EXIT_FAILURE;
+        running = 0;
+    } else {
+        for ( i = firstjob; i < cntjobs && jobs[i].pid != pid; i++ );
+        if ( i == cntjobs )
+            return;
+        jobs[i].status = ( WIFEXITED( status ) ? WEXITSTATUS( status ) : EXIT_FAILURE );
+        running--;
+    }
+    FlushJobs();
+}
+
+/* get a free item in jobs[]; returns NULL if there's no memory */
+
+static struct job *NewJob( void )
+/*******************************/
+{
+    struct job *job;
+
+    if ( cntjobs == maxjobs ) {
+        maxjobs = ( maxjobs ? maxjobs * 2 : 64 );
+        job = malloc( maxjobs * sizeof( struct job ) );
+        if ( job == NULL )
+            return( NULL );
+        if ( jobs ) {
+            memcpy( job, jobs, cntjobs * sizeof( struct job ) );
+            free( jobs );
+        }
+        jobs = job;
+    }
+    return( &jobs[cntjobs] );
+}
+
+/* add a job to jobs[] and create a worker process for it.
+ * <seedout> and <seederr> are output that precedes the worker's output.
+ * returns the result of fork(): 0 in the worker, -1 if no worker could be created.
+ */
+static pid_t ForkJob( FILE *seedout, FILE *seederr )
+/**************************************************/
+{
+    struct job *job;
+
+    while ( running >= Options.jobs )
+        WaitJob();
+    if ( ( job = NewJob() ) == NULL )
+        return( -1 );
+    if ( ( job->out = tmpfile() ) == NULL )
+        return( -1 );
+    if ( ( job->err = tmpfile() ) == NULL ) {
+        fclose( job->out );
+        return( -1 );
+    }
+    if ( seedout ) {
+        AppendOutput( seedout, job->out );
+        AppendOutput( seederr, job->err );
+    }
+    fflush( stdout );
+    fflush( stderr );
+    if ( ( job->pid = fork() ) == -1 ) {
+        fclose( job->out );
+        fclose( job->err );
+        return( -1 );
+    }
+    if ( job->pid == 0 ) {
+        /* the worker */
+        dup2( fileno( job->out ), STDOUT_FILENO );
+        dup2( fileno( job->err ), STDERR_FILENO );
+        return( 0 );
+    }
+    job->status = -1;
+    cntjobs++;
+    running++;
+    return( job->pid );
+}
+
+/* terminate a worker */
+
+static void ExitJob( int rc )
+/***************************/
+{
+    fflush( stdout );
+    fflush( stderr );
+    _exit( 1 - rc );
+}
+
+/* start a worker to assemble a module.
+ * returns FALSE if no worker could be created.
+ */
+static bool StartJob( const char *fname )
+/***************************************/
+{
+    switch ( ForkJob( NULL, NULL ) ) {
+    case -1:
+        return( FALSE );
+    case 0:
+        ExitJob( AssembleModule( fname ) );
+    }
+    return( TRUE );
+}
+
+/* wait until all workers have terminated; returns FALSE if an error occured */
+
+static bool FinishJobs( void )
+/****************************/
+{
+    while ( running )
+        WaitJob();
+    FlushJobs();
+    if ( jobs )
+        free( jobs );
+    jobs = NULL;
+    cntjobs = maxjobs = firstjob = 0;
+    return( !jobfailed );
+}
+
+#if FORKSUPP
+
+/* get the options that must match for modules forked from the template.
+ * file names are module-specific; option queues may have been extended.
+ */
+static void GetTmplOptions( struct global_options *options, struct qitem **tails )
+/********************************************************************************/
+{
+    int i;
+    struct qitem *q;
+
+    memcpy( options, &Options, sizeof( struct global_options ) );
+    memset( options->names, 0, NUM_FILE_TYPES * sizeof( options->names[0] ) );
+    options->jobs = 0;
+    for ( i = 0; i < OPTQ_LAST; i++ ) {
+        for ( q = Options.queues[i]; q && q->next; q = q->next );
+        tails[i] = q;
+    }
+}
+
+/* may a module be forked from the template? Besides the options,
+ * the directory must match, since it's searched for include files.
+ */
+static bool MatchesTemplate( const char *fname )
+/**********************************************/
+{
+    struct global_options options;
+    struct qitem *tails[OPTQ_LAST];
+    const char *src = GetFName( ModuleInfo.srcfile )->fname;
+    int dirsize = GetFNamePart( src ) - src;
+
+    GetTmplOptions( &options, tails );
+    return( memcmp( &options, &tmpl.options, sizeof( options ) ) == 0 &&
+           memcmp( tails, tmpl.tails, sizeof( tails ) ) == 0 &&
+           GetFNamePart( fname ) - fname == dirsize &&
+           memcmp( fname, src, dirsize ) == 0 );
+}
+
+/* redirect stdout/stderr of the template to temporary files */
+
+static bool CaptureOutput( void )
+/*******************************/
+{
+    if ( ( tmpl.out = tmpfile() ) == NULL )
+        return( FALSE );
+    if ( ( tmpl.err = tmpfile() ) == NULL ) {
+        fclose( tmpl.out );
+        return( FALSE );
+    }
+    fflush( stdout );
+    fflush( stderr );
+    tmpl.outfd = dup( STDOUT_FILENO );
+    tmpl.errfd = dup( STDERR_FILENO );
+    dup2( fileno( tmpl.out ), STDOUT_FILENO );
+    dup2( fileno( tmpl.err ), STDERR_FILENO );
+    return( TRUE );
+}
+
+static void RestoreOutput( void )
+/*******************************/
+{
+    fflush( stdout );
+    fflush( stderr );
+    dup2( tmpl.outfd, STDOUT_FILENO );
+    dup2( tmpl.errfd, STDERR_FILENO );
+    close( tmpl.outfd );
+    close( tmpl.errfd );
+}
+
+/* called by the template after the -Fi files have been processed.
+ * A worker is forked for the template's module, then the cmdline is
+ * scanned for more modules that match the template. The workers
+ * return FALSE and continue to assemble their module; the template
+ * returns TRUE if it's done.
+ */
+static bool ForkTemplate( void )
+/******************************/
+{
+    pid_t pid;
+    const char *fname = NULL;
+
+    DebugMsg(("ForkTemplate enter\n"));
+    GetTmplOptions( &tmpl.options, tmpl.tails );
+    RestoreOutput();
+    for ( ;; ) {
+        if ( ( pid = ForkJob( tmpl.out, tmpl.err ) ) == 0 ) {
+            tmpl.state = TS_WORKER;
+            if ( fname )
+                RetargetModule( fname );
+            return( FALSE );
+        }
+        if ( pid == -1 ) {
+            if ( fname == NULL ) {
+                /* no worker; the template continues, output must be written in order */
+                FinishJobs();
+                CopyOutput( tmpl.out, stdout );
+                CopyOutput( tmpl.err, stderr );
+                tmpl.state = TS_NONE;
+                return( FALSE );
+            }
+            /* the module is assembled without template */
+            tmpl.pending = TRUE;
+            break;
+        }
+        if ( fname == NULL )
+            AbandonModule();
+        if ( ( fname = ParseCmdline( tmpl.argv, tmpl.pnumArgs ) ) == NULL ) {
+            tmpl.eoc = TRUE;
+            break;
+        }
+        if ( MatchesTemplate( fname ) == FALSE ) {
+            DebugMsg(("ForkTemplate: %s doesn't match template\n", fname ));
+            tmpl.pending = TRUE;
+            break;
+        }
+    }
+    fclose( tmpl.out );
+    fclose( tmpl.err );
+    tmpl.state = TS_NONE;
+    return( TRUE );
+}
+
+/* assemble a module as template */
+
+static int RunTemplate( const char *fname )
+/*****************************************/
+{
+    struct job *job;
+    int rc;
+
+    if ( Options.jobs == 0 )
+        Options.jobs = sysconf( _SC_NPROCESSORS_ONLN );
+    if ( CaptureOutput() == FALSE )
+        return( AssembleModule( fname ) );
+    tmpl.state = TS_PRELUDE;
+    ForkModules = ForkTemplate;
+    rc = AssembleModule( fname );
+    ForkModules = NULL;
+    switch ( tmpl.state ) {
+    case TS_WORKER:
+        ExitJob( rc );
+    case TS_PRELUDE:
+        /* the state couldn't be used; the output is written in cmdline order */
+        RestoreOutput();
+        if ( ( job = NewJob() ) == NULL ) {
+            FinishJobs();
+            CopyOutput( tmpl.out, stdout );
+            CopyOutput( tmpl.err, stderr );
+        } else {
+            job->pid = 0;
+            job->out = tmpl.out;
+            job->err = tmpl.err;
+            job->status = 1 - rc;
+            cntjobs++;
+            FlushJobs();
+        }
+        tmpl.state = TS_NONE;
+    }
+    return( rc );
+}
+
+/* get the next module; ForkTemplate() may have scanned the cmdline already */
+
+static char *NextModule( const char **argv, int *pnumArgs )
+/*********************************************************/
+{
+    if ( tmpl.pending ) {
+        tmpl.pending = FALSE;
+        return( Options.names[ASM] );
+    }
+    if ( tmpl.eoc )
+        return( NULL );
+    return( ParseCmdline( argv, pnumArgs ) );
+}
+
+#endif
+
+#endif
+
 static void genfailure( int signo )
 /*********************************/
 {
@@ -59,8 +464,11 @@ static void genfailure( int signo )
     exit( EXIT_FAILURE );
 }
 
-int main( int argc, char **argv )
-/*******************************/
+/* assemble the modules of a cmdline; returns the exit code.
+ * v2.21: called once by main() - or for each job by the server.
+ */
+static int AssembleCmdline( char **argv )
+/***************************************/
 {
     char    *pEnv;
     int     numArgs = 0;
@@ -78,34 +486,27 @@ int main( int argc, char **argv )
     char    fname[FILENAME_MAX];
 #endif
 
-#if 0 //def DEBUG_OUT    /* DebugMsg() cannot be used that early */
-    int i;
-    for ( i = 1; i < argc; i++ ) {
-        printf("argv[%u]=>%s<\n", i, argv[i] );
-    }
-#endif
-
-#ifdef TRMEM
-    tm_Init();
-#endif
-
     pEnv = getenv( "JWASM" );
     if ( pEnv == NULL )
         pEnv = "";
     argv[0] = pEnv;
 
-#ifndef DEBUG_OUT
-    signal(SIGSEGV, genfailure);
+#if PARALLEL
+    jobfailed = FALSE;
 #endif
-
-#if CATCHBREAK
-    signal(SIGBREAK, genfailure);
-#else
-    signal(SIGTERM, genfailure);
+#if FORKSUPP
+    tmpl.pending = FALSE;
+    tmpl.eoc = FALSE;
 #endif
 
     /* ParseCmdLine() returns NULL if no source file name has been found (anymore) */
+#if FORKSUPP
+    tmpl.argv = (const char **)argv;
+    tmpl.pnumArgs = &numArgs;
+    while ( NextModule( (const char **)argv, &numArgs ) ) {
+#else
     while ( ParseCmdline( (const char **)argv, &numArgs ) ) {
+#endif
         numFiles++;
         write_logo();
 #if WILDCARDS
@@ -130,9 +531,40 @@ int main( int argc, char **argv )
         } while ( ( _findnext( fh, &finfo ) != -1 ) );
         _findclose( fh );
 #else
+#if FORKSUPP
+        if ( Options.fork_modules && Options.queues[OPTQ_FINCLUDE] ) {
+            rc = RunTemplate( Options.names[ASM] );
+            if ( rc == 0 )
+                jobfailed = TRUE;
+            continue;
+        }
+#endif
+#if PARALLEL
+        if ( Options.jobs > 1 ) {
+            if ( StartJob( Options.names[ASM] ) ) {
+                rc = 1;
+                continue;
+            }
+            /* no worker available; output must be written in order */
+            FinishJobs();
+        }
+#endif
         rc = AssembleModule( Options.names[ASM] );
+#if PARALLEL
+        if ( rc == 0 && Options.jobs > 1 )
+            jobfailed = TRUE;
+#endif
 #endif
     };
+#if PARALLEL
+    /* v2.21: with -j, the exit code covers all modules */
+    if ( FinishJobs() == FALSE )
+        rc = 0;
+#endif
+#if OBJCACHE
+    if ( Options.print_cache_stats )
+        ObjCachePrintStats();
+#endif
     CmdlineFini();
     if ( numArgs == 0 ) {
         write_logo();
@@ -140,10 +572,54 @@ int main( int argc, char **argv )
     } else if ( numFiles == 0 )
         EmitError( NO_FILENAME_SPECIFIED );
 
+    return( 1 - rc ); /* zero if no errors */
+}
+
+int main( int argc, char **argv )
+/*******************************/
+{
+    int     rc;
+
+#if 0 //def DEBUG_OUT    /* DebugMsg() cannot be used that early */
+    int i;
+    for ( i = 1; i < argc; i++ ) {
+        printf("argv[%u]=>%s<\n", i, argv[i] );
+    }
+#endif
+
+#ifdef TRMEM
+    tm_Init();
+#endif
+
+#ifndef DEBUG_OUT
+    signal(SIGSEGV, genfailure);
+#endif
+
+#if CATCHBREAK
+    signal(SIGBREAK, genfailure);
+#else
+    signal(SIGTERM, genfailure);
+#endif
+
+#if SERVERSUPP
+    /* v2.21: -server and -client must be the first argument */
+    if ( argc == 3 && strcmp( argv[1], "-server" ) == 0 )
+        return( RunServer( argv[2], AssembleCmdline ) );
+    if ( argc > 2 && strcmp( argv[1], "-client" ) == 0 ) {
+        if ( ( rc = RunClient( argv[2], argv + 3 ) ) != -1 )
+            return( rc );
+        /* no server running, assemble the modules here */
+        argv += 2;
+    }
+#endif
+
+    rc = AssembleCmdline( argv );
+    InputCacheFini(); /* v2.21: release cached include files */
+
 #ifdef TRMEM
     tm_Fini();
 #endif
 
-    DebugMsg(("main: exit, return code=%u\n", 1 - rc ));
-    return( 1 - rc ); /* zero if no errors */
+    DebugMsg(("main: exit, return code=%u\n", rc ));
+    return( rc ); /* zero if no errors */
 }
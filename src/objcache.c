@@ -0,0 +1,657 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  object cache ( cmdline option -Fc ).
+*               The outputs of an assembly ( object module, listing and
+*               error file ) are stored in a cache directory. The key is
+*               a hash of the options, the file names and the content of
+*               the main source. A manifest, <key>.m, lists the files that
+*               have been read by the assembly ( include files, the files
+*               of -Fi and INCBIN ) with size and hash of their content.
+*               If the manifest exists and all files are unchanged, the
+*               outputs are copied from the cache and no pass is run.
+*               Statistics are kept in file "stats" of the cache directory.
+*
+****************************************************************************/
+
+#include <ctype.h>
+#include <sys/stat.h>
+#if defined(__UNIX__)
+    #include <unistd.h>
+    #include <sys/file.h>
+#else
+    #include <direct.h>
+#endif
+
+#include "globals.h"
+#include "memalloc.h"
+#include "msgtext.h"
+#include "input.h"
+#include "objcache.h"
+
+#if OBJCACHE
+
+/* the id must be changed if the format of the manifest changes.
+ * Date and time of compilation are added, so a new binary won't
+ * use the entries of a previous one.
+ */
+#define CACHE_ID "JWasm object cache 1"
+#define CACHE_STAMP CACHE_ID " " __DATE__ " " __TIME__
+
+#if defined(__UNIX__)
+#define GETCWD getcwd
+#define MKDIR( dir ) mkdir( dir, 0777 )
+#define DIR_SEPARATOR '/'
+#define ISPC( x ) ( x == '/' )
+#else
+#define GETCWD _getcwd
+#define MKDIR( dir ) _mkdir( dir )
+#define DIR_SEPARATOR '\\'
+#define ISPC( x ) ( x == '/' || x == '\\' || x == ':' )
+#endif
+
+/* 64-bit FNV-1a; the constants are composed of 32-bit halves */
+#define FNV_BASIS ( ( (uint_64)0xCBF29CE4 << 32 ) | 0x84222325 )
+#define FNV_PRIME ( ( (uint_64)0x100 << 32 ) | 0x1B3 )
+
+enum stat_items {
+    STAT_HITS,
+    STAT_MISSES,
+    STAT_NOCACHE,
+    STAT_LAST
+};
+
+/* a text buffer that grows as needed */
+struct textbuf {
+    char        *base;
+    unsigned    size;
+    unsigned    max;
+};
+
+/* state of the current module; reset by ObjCacheLookup() */
+static struct {
+    bool        active;     /* module may be cached */
+    bool        hit;        /* outputs copied from cache */
+    bool        collected;  /* assembly finished, dependencies known */
+    char        key[17];    /* hash as hex string */
+    unsigned    lines;
+    unsigned    passes;
+    struct textbuf incbin;  /* names of INCBIN files, 00-terminated */
+    struct textbuf echo;    /* text displayed by ECHO */
+    struct textbuf deps;    /* dependency lines of the manifest */
+} oc;
+
+static uint_64 hashbytes( uint_64 h, const void *p, size_t size )
+/***************************************************************/
+{
+    const uint_8 *q = p;
+
+    for ( ; size; size--, q++ ) {
+        h ^= *q;
+        h *= FNV_PRIME;
+    }
+    return( h );
+}
+
+static uint_64 hashstr( uint_64 h, const char *s )
+/************************************************/
+{
+    return( s ? hashbytes( h, s, strlen( s ) + 1 ) : hashbytes( h, "", 1 ) );
+}
+
+static void AddText( struct textbuf *tb, const char *text, unsigned len )
+/***********************************************************************/
+{
+    char *newp;
+
+    if ( tb->size + len + 1 > tb->max ) {
+        tb->max = ( tb->size + len + 1 ) * 2;
+        newp = MemAlloc( tb->max );
+        if ( tb->base ) {
+            memcpy( newp, tb->base, tb->size );
+            MemFree( tb->base );
+        }
+        tb->base = newp;
+    }
+    memcpy( tb->base + tb->size, text, len );
+    tb->size += len;
+    tb->base[tb->size] = NULLC;
+}
+
+static void FreeText( struct textbuf *tb )
+/****************************************/
+{
+    if ( tb->base )
+        MemFree( tb->base );
+    memset( tb, 0, sizeof( struct textbuf ) );
+}
+
+/* read a file into a text buffer; the file is opened in
+ * binary or text mode. Returns FALSE if it cannot be read.
+ */
+static bool ReadFile( const char *name, const char *mode, struct textbuf *tb )
+/****************************************************************************/
+{
+    FILE *f;
+    char buffer[0x1000];
+    size_t size;
+
+    if ( ( f = fopen( name, mode ) ) == NULL )
+        return( FALSE );
+    while ( ( size = fread( buffer, 1, sizeof( buffer ), f ) ) > 0 )
+        AddText( tb, buffer, size );
+    size = ferror( f );
+    fclose( f );
+    return( size == 0 );
+}
+
+/* read a file and calculate its hash.
+ * if the text contains references to predefined text macros
+ * whose value depends on time or environment, the outputs
+ * cannot be cached.
+ */
+static bool GetFileHash( const char *name, uint_32 *psize, uint_64 *phash )
+/*************************************************************************/
+{
+    static const char * const volatiles[] = { "@Date", "@Time", "@Environ" };
+    struct textbuf tb = { NULL, 0, 0 };
+    char *p;
+    char *end;
+    int i;
+    bool rc;
+
+    if ( rc = ReadFile( name, "rb", &tb ) ) {
+        *psize = tb.size;
+        *phash = hashbytes( FNV_BASIS, tb.base, tb.size );
+        for ( p = tb.base, end = tb.base + tb.size; p < end && rc; p++ ) {
+            if ( *p == '@' && ( p == tb.base || !is_valid_id_char( *(p-1) ) ) ) {
+                for ( i = 0; i < sizeof( volatiles ) / sizeof( volatiles[0] ); i++ ) {
+                    int len = strlen( volatiles[i] );
+                    if ( p + len <= end && _memicmp( p, volatiles[i], len ) == 0 &&
+                        ( p + len == end || !is_valid_id_char( *(p+len) ) ) ) {
+                        DebugMsg(("GetFileHash(%s): %s found\n", name, volatiles[i] ));
+                        rc = FALSE;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    FreeText( &tb );
+    return( rc );
+}
+
+/* calculate the key of the current module.
+ * Options that don't affect the outputs are excluded.
+ */
+static bool GetKey( void )
+/************************/
+{
+    struct global_options opts;
+    struct qitem *q;
+    const char *env;
+    uint_64 h = FNV_BASIS;
+    uint_64 srchash;
+    uint_32 srcsize;
+    int i;
+    char cwd[FILENAME_MAX];
+
+    if ( GetFileHash( CurrFName[ASM], &srcsize, &srchash ) == FALSE )
+        return( FALSE );
+    h = hashstr( h, CACHE_STAMP );
+    memcpy( &opts, &Options, sizeof( opts ) );
+    memset( opts.names, 0, sizeof( opts.names ) );
+    memset( opts.queues, 0, sizeof( opts.queues ) );
+    opts.quiet = FALSE;
+    opts.error_limit = 0;
+    opts.no_error_disp = 0;
+    opts.print_cache_stats = FALSE;
+#if defined(__UNIX__)
+    opts.cache_incdirs = FALSE;
+    opts.jobs = 0;
+    opts.fork_modules = FALSE;
+#endif
+#if PREFETCH
+    opts.read_ahead = FALSE;
+#endif
+    h = hashbytes( h, &opts, sizeof( opts ) );
+    for ( i = OPTN_MODULE_NAME; i < OPTN_LAST; i++ )
+        h = hashstr( h, Options.names[i] );
+    for ( i = 0; i < OPTQ_LAST; i++ )
+        for ( q = Options.queues[i]; q; q = q->next )
+            h = hashstr( h, q->value );
+    h = hashstr( h, CurrFName[ASM] );
+    h = hashstr( h, CurrFName[OBJ] );
+    env = ( Options.ignore_include ? NULL : getenv( "INCLUDE" ) );
+    h = hashstr( h, env );
+    /* the debug info contains the current directory */
+    if ( Options.line_numbers || Options.debug_symbols ) {
+        if ( GETCWD( cwd, sizeof( cwd ) ) == NULL )
+            cwd[0] = NULLC;
+        h = hashstr( h, cwd );
+    }
+    h = hashbytes( h, &srcsize, sizeof( srcsize ) );
+    h = hashbytes( h, &srchash, sizeof( srchash ) );
+    sprintf( oc.key, "%08X%08X", (uint_32)( h >> 32 ), (uint_32)h );
+    return( TRUE );
+}
+
+/* get name of a file in the cache directory; the name is
+ * either "<key>.<ext>" or, if key is NULL, <ext>.
+ */
+static char *GetCacheName( const char *key, const char *ext )
+/***********************************************************/
+{
+    const char *dir = Options.names[OPTN_CACHE_DIR];
+    char *name = MemAlloc( strlen( dir ) + 1 + sizeof( oc.key ) + strlen( ext ) + 2 );
+    char *p = name;
+
+    strcpy( p, dir );
+    p += strlen( p );
+    if ( p != name && !ISPC( *(p-1) ) )
+        *p++ = DIR_SEPARATOR;
+    if ( key )
+        sprintf( p, "%s.%s", key, ext );
+    else
+        strcpy( p, ext );
+    return( name );
+}
+
+/* copy a file of the cache to an output file */
+
+static bool CopyFromCache( const char *ext, FILE *out )
+/*****************************************************/
+{
+    struct textbuf tb = { NULL, 0, 0 };
+    char *name = GetCacheName( oc.key, ext );
+    bool rc;
+
+    rc = ReadFile( name, "rb", &tb );
+    MemFree( name );
+    if ( rc && tb.size && fwrite( tb.base, 1, tb.size, out ) != tb.size )
+        rc = FALSE;
+    FreeText( &tb );
+    return( rc );
+}
+
+/* write a file to the cache directory. The data is written to a
+ * temporary file first, which is then renamed. With -j, several
+ * processes may store the same entry.
+ */
+static bool WriteToCache( const char *ext, const char *data, unsigned size )
+/**************************************************************************/
+{
+    FILE *f;
+    char *name = GetCacheName( oc.key, ext );
+    char *tmpname = MemAlloc( strlen( name ) + 16 );
+    bool rc = FALSE;
+
+#if defined(__UNIX__)
+    sprintf( tmpname, "%s.%u", name, (unsigned)getpid() );
+#else
+    sprintf( tmpname, "%s.tmp", name );
+#endif
+    if ( f = fopen( tmpname, "wb" ) ) {
+        bool ok = ( size == 0 || fwrite( data, 1, size, f ) == size );
+        if ( fclose( f ) == 0 && ok ) {
+            if ( rename( tmpname, name ) != 0 ) {
+                remove( name );
+                if ( rename( tmpname, name ) == 0 )
+                    rc = TRUE;
+            } else
+                rc = TRUE;
+        }
+        if ( rc == FALSE )
+            remove( tmpname );
+    }
+    MemFree( tmpname );
+    MemFree( name );
+    return( rc );
+}
+
+/* copy an output file to the cache directory */
+
+static bool CopyToCache( const char *ext, const char *filename )
+/**************************************************************/
+{
+    struct textbuf tb = { NULL, 0, 0 };
+    bool rc;
+
+    if ( rc = ReadFile( filename, "rb", &tb ) )
+        rc = WriteToCache( ext, tb.base, tb.size );
+    FreeText( &tb );
+    return( rc );
+}
+
+/* read or update the statistics. The file is locked, since
+ * several processes may access it ( option -j ).
+ */
+static void AccessStats( int item, unsigned *stats )
+/**************************************************/
+{
+    FILE *f;
+    char *name = GetCacheName( NULL, "stats" );
+    int i;
+
+    memset( stats, 0, STAT_LAST * sizeof( unsigned ) );
+    if ( ( f = fopen( name, "r+" ) ) == NULL && item != STAT_LAST )
+        f = fopen( name, "w+" );
+    MemFree( name );
+    if ( f == NULL )
+        return;
+#if defined(__UNIX__)
+    flock( fileno( f ), LOCK_EX );
+#endif
+    if ( fscanf( f, "%u %u %u", &stats[STAT_HITS], &stats[STAT_MISSES], &stats[STAT_NOCACHE] ) != STAT_LAST )
+        memset( stats, 0, STAT_LAST * sizeof( unsigned ) );
+    if ( item != STAT_LAST ) {
+        stats[item]++;
+        rewind( f );
+        for ( i = 0; i < STAT_LAST; i++ )
+            fprintf( f, "%u%c", stats[i], i == STAT_LAST - 1 ? '\n' : ' ' );
+        fflush( f );
+    }
+    fclose( f ); /* releases the lock */
+}
+
+static void CountStat( int item )
+/*******************************/
+{
+    unsigned stats[STAT_LAST];
+
+    AccessStats( item, stats );
+}
+
+/* read the next line of the manifest; the line is terminated */
+
+static char *NextLine( char **pp, char *end )
+/*******************************************/
+{
+    char *line = *pp;
+    char *p;
+
+    if ( line >= end )
+        return( NULL );
+    for ( p = line; p < end && *p != '\n'; p++ );
+    *p = NULLC;
+    *pp = p + 1;
+    return( line );
+}
+
+/* get a text block of the manifest: "<tag> <length>\n<text>" */
+
+static char *GetBlock( char **pp, char *end, char tag, unsigned *plen )
+/*********************************************************************/
+{
+    char *line = NextLine( pp, end );
+    char *text = *pp;
+
+    if ( line == NULL || line[0] != tag || sscanf( line + 1, "%u", plen ) != 1 ||
+        *plen > end - text )
+        return( NULL );
+    *pp += *plen;
+    return( text );
+}
+
+/* called by AssembleModule() after the files have been opened.
+ * If the manifest is valid, the outputs are copied from the cache
+ * and TRUE is returned; then no pass has to be run.
+ */
+bool ObjCacheLookup( void )
+/*************************/
+{
+    struct textbuf man = { NULL, 0, 0 };
+    char *name;
+    char *p;
+    char *end;
+    char *line;
+    char *msgs = NULL;
+    char *echo = NULL;
+    unsigned msglen = 0;
+    unsigned echolen = 0;
+    unsigned lines, passes, warnings;
+    unsigned size;
+    uint_32 fsize;
+    uint_64 fhash;
+    char hexhash[17];
+    char currhash[17];
+    int ofs;
+    bool valid = FALSE;
+    bool hasobj = FALSE;
+    bool haslst = FALSE;
+
+    FreeText( &oc.incbin );
+    FreeText( &oc.echo );
+    FreeText( &oc.deps );
+    memset( &oc, 0, sizeof( oc ) );
+
+    /* a source supplied by the caller ( libjwasm ) isn't cached */
+    if ( Options.names[OPTN_CACHE_DIR] == NULL || ExtFile[ASM] )
+        return( FALSE );
+    if ( Options.preprocessor_stdout || Options.write_impdef || GetKey() == FALSE ) {
+        DebugMsg(("ObjCacheLookup(%s): not cacheable\n", CurrFName[ASM] ));
+        MKDIR( Options.names[OPTN_CACHE_DIR] );
+        CountStat( STAT_NOCACHE );
+        return( FALSE );
+    }
+    oc.active = TRUE;
+    MKDIR( Options.names[OPTN_CACHE_DIR] );
+
+    name = GetCacheName( oc.key, "m" );
+    if ( ReadFile( name, "rb", &man ) ) {
+        p = man.base;
+        end = man.base + man.size;
+        if ( ( line = NextLine( &p, end ) ) && strcmp( line, CACHE_STAMP ) == 0 &&
+            ( line = NextLine( &p, end ) ) &&
+            sscanf( line, "%u %u %u", &lines, &passes, &warnings ) == 3 ) {
+            valid = TRUE;
+            /* check the dependencies */
+            while ( valid && p < end && *p == 'F' ) {
+                line = NextLine( &p, end );
+                if ( sscanf( line, "F %u %16s %n", &size, hexhash, &ofs ) < 2 ||
+                    GetFileHash( line + ofs, &fsize, &fhash ) == FALSE ) {
+                    valid = FALSE;
+                    break;
+                }
+                sprintf( currhash, "%08X%08X", (uint_32)( fhash >> 32 ), (uint_32)fhash );
+                if ( size != fsize || strcmp( currhash, hexhash ) != 0 ) {
+                    DebugMsg(("ObjCacheLookup(%s): %s has changed\n", CurrFName[ASM], line + ofs ));
+                    valid = FALSE;
+                }
+            }
+            if ( valid && p < end && *p == 'O' ) {
+                NextLine( &p, end );
+                hasobj = TRUE;
+            }
+            if ( valid && p < end && *p == 'L' ) {
+                NextLine( &p, end );
+                haslst = TRUE;
+            }
+            if ( valid && ( ( msgs = GetBlock( &p, end, 'E', &msglen ) ) == NULL ||
+                ( echo = GetBlock( &p, end, 'C', &echolen ) ) == NULL ) )
+                valid = FALSE;
+        }
+    }
+    MemFree( name );
+    /* the outputs must match the options */
+    if ( valid &&
+        ( hasobj != ( CurrFile[OBJ] != NULL ) || haslst != ( CurrFile[LST] != NULL ) ) )
+        valid = FALSE;
+
+    if ( valid && CurrFile[OBJ] && CopyFromCache( "o", CurrFile[OBJ] ) == FALSE )
+        valid = FALSE;
+    if ( valid && CurrFile[LST] && CopyFromCache( "l", CurrFile[LST] ) == FALSE )
+        valid = FALSE;
+    if ( valid == FALSE ) {
+        DebugMsg(("ObjCacheLookup(%s): miss, key=%s\n", CurrFName[ASM], oc.key ));
+        /* the outputs may have been partially written */
+        if ( CurrFile[OBJ] && ftell( CurrFile[OBJ] ) )
+            CurrFile[OBJ] = freopen( CurrFName[OBJ], "wb", CurrFile[OBJ] );
+        if ( CurrFile[LST] && ftell( CurrFile[LST] ) )
+            CurrFile[LST] = freopen( CurrFName[LST], "wb", CurrFile[LST] );
+        FreeText( &man );
+        return( FALSE );
+    }
+
+    DebugMsg(("ObjCacheLookup(%s): hit, key=%s\n", CurrFName[ASM], oc.key ));
+    oc.hit = TRUE;
+    if ( msglen ) {
+        write_logo();
+        if ( Options.no_error_disp == FALSE ) {
+            fwrite( msgs, 1, msglen, errout );
+            fflush( errout );
+        }
+        if ( CurrFName[ERR] && ( CurrFile[ERR] = fopen( CurrFName[ERR], "w" ) ) )
+            fwrite( msgs, 1, msglen, CurrFile[ERR] );
+    }
+    if ( echolen )
+        fwrite( echo, 1, echolen, stdout );
+    ModuleInfo.g.warning_count = warnings;
+    if ( Options.quiet == FALSE ) {
+        printf( MsgGetEx( MSG_ASSEMBLY_RESULTS ),
+               GetFName( ModuleInfo.srcfile )->fname, (unsigned long)lines, passes, 0, warnings, 0 );
+        printf( "\n" );
+    }
+    CountStat( STAT_HITS );
+    FreeText( &man );
+    return( TRUE );
+}
+
+/* called by SearchFile() for files that aren't pushed onto the
+ * source stack ( INCBIN ); the other files are found in FNames.
+ */
+void ObjCacheAddFile( const char *name )
+/**************************************/
+{
+    if ( oc.active && Parse_Pass == PASS_1 )
+        AddText( &oc.incbin, name, strlen( name ) + 1 );
+}
+
+/* called by EchoDirective() and PchLoad(); the echoed text is
+ * displayed again if the outputs are copied from the cache.
+ */
+void ObjCacheEcho( const char *text, bool addnl )
+/***********************************************/
+{
+    if ( oc.active ) {
+        AddText( &oc.echo, text, strlen( text ) );
+        if ( addnl )
+            AddText( &oc.echo, "\n", 1 );
+    }
+}
+
+static bool AddDependency( const char *name )
+/*******************************************/
+{
+    char line[64];
+    uint_32 size;
+    uint_64 hash;
+
+    if ( GetFileHash( name, &size, &hash ) == FALSE ) {
+        DebugMsg(("ObjCacheCollect: %s cannot be cached\n", name ));
+        return( FALSE );
+    }
+    sprintf( line, "F %" I32_SPEC "u %08X%08X ", size, (uint_32)( hash >> 32 ), (uint_32)hash );
+    AddText( &oc.deps, line, strlen( line ) );
+    AddText( &oc.deps, name, strlen( name ) );
+    AddText( &oc.deps, "\n", 1 );
+    return( TRUE );
+}
+
+/* called by AssembleModule() when the assembly has finished.
+ * The files that have been read are hashed now.
+ */
+void ObjCacheCollect( unsigned lines, unsigned passes )
+/*****************************************************/
+{
+    unsigned i;
+    const char *p;
+
+    if ( oc.active == FALSE || oc.hit )
+        return;
+    oc.lines = lines;
+    oc.passes = passes;
+    for ( i = 0; i < ModuleInfo.g.cnt_fnames; i++ )
+        if ( i != ModuleInfo.srcfile && AddDependency( GetFName( i )->fname ) == FALSE )
+            return;
+    if ( oc.incbin.base )
+        for ( p = oc.incbin.base; p < oc.incbin.base + oc.incbin.size; p += strlen( p ) + 1 )
+            if ( AddDependency( p ) == FALSE )
+                return;
+    oc.collected = TRUE;
+}
+
+/* called by AssembleFini() after the output files have been closed.
+ * If the module has been assembled without errors, the outputs
+ * are copied to the cache and the manifest is written.
+ */
+void ObjCacheStore( void )
+/************************/
+{
+    struct textbuf man = { NULL, 0, 0 };
+    struct textbuf msgs = { NULL, 0, 0 };
+    char buffer[64];
+
+    if ( oc.active == FALSE || oc.hit )
+        goto done;
+    if ( oc.collected == FALSE || ModuleInfo.g.error_count ) {
+        CountStat( STAT_NOCACHE );
+        goto done;
+    }
+    /* the error file contains the warnings */
+    if ( ModuleInfo.g.warning_count && CurrFName[ERR] )
+        ReadFile( CurrFName[ERR], "r", &msgs );
+    if ( ( Options.syntax_check_only || CopyToCache( "o", CurrFName[OBJ] ) ) &&
+        ( Options.write_listing == FALSE || CopyToCache( "l", CurrFName[LST] ) ) ) {
+        AddText( &man, CACHE_STAMP "\n", strlen( CACHE_STAMP ) + 1 );
+        sprintf( buffer, "%u %u %u\n", oc.lines, oc.passes, ModuleInfo.g.warning_count );
+        AddText( &man, buffer, strlen( buffer ) );
+        if ( oc.deps.base )
+            AddText( &man, oc.deps.base, oc.deps.size );
+        if ( Options.syntax_check_only == FALSE )
+            AddText( &man, "O\n", 2 );
+        if ( Options.write_listing )
+            AddText( &man, "L\n", 2 );
+        sprintf( buffer, "E %u\n", msgs.size );
+        AddText( &man, buffer, strlen( buffer ) );
+        if ( msgs.base )
+            AddText( &man, msgs.base, msgs.size );
+        sprintf( buffer, "C %u\n", oc.echo.size );
+        AddText( &man, buffer, strlen( buffer ) );
+        if ( oc.echo.base )
+            AddText( &man, oc.echo.base, oc.echo.size );
+        if ( WriteToCache( "m", man.base, man.size ) ) {
+            DebugMsg(("ObjCacheStore(%s): stored, key=%s\n", CurrFName[ASM], oc.key ));
+            CountStat( STAT_MISSES );
+            goto done;
+        }
+    }
+    DebugMsg(("ObjCacheStore(%s): outputs couldn't be stored\n", CurrFName[ASM] ));
+    CountStat( STAT_NOCACHE );
+done:
+    FreeText( &man );
+    FreeText( &msgs );
+    FreeText( &oc.incbin );
+    FreeText( &oc.echo );
+    FreeText( &oc.deps );
+    oc.active = FALSE;
+}
+
+/* -Fcs: display the statistics of the cache directory */
+
+void ObjCachePrintStats( void )
+/*****************************/
+{
+    unsigned stats[STAT_LAST];
+
+    if ( Options.names[OPTN_CACHE_DIR] == NULL )
+        return;
+    AccessStats( STAT_LAST, stats );
+    printf( MsgGetEx( MSG_CACHE_STATS ), Options.names[OPTN_CACHE_DIR],
+           stats[STAT_HITS], stats[STAT_MISSES], stats[STAT_NOCACHE] );
+}
+
+#endif
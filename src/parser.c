@@ -3553,7 +3553,17 @@ ret_code ParseLine( struct asm_tok tokenarray[] )
 void ProcessFile( struct asm_tok tokenarray[] )
 /*********************************************/
 {
-    while ( ModuleInfo.EndDirFound == FALSE && GetTextLine( CurrSource ) ) {
+    while ( ModuleInfo.EndDirFound == FALSE ) {
+#if SKIPSCAN
+        /* v2.21: lines of an inactive block are skipped without Tokenize().
+         * Not done if those lines may be listed or written by -EP.
+         */
+        if ( CurrIfState != BLOCK_ACTIVE && ModuleInfo.inside_comment == NULLC &&
+            ModuleInfo.listif == FALSE && Options.preprocessor_stdout == FALSE )
+            SkipFalseLines();
+#endif
+        if ( GetTextLine( CurrSource ) == NULL )
+            break;
         if ( PreprocessLine( CurrSource, tokenarray ) ) {
             ParseLine( tokenarray );
             if ( Options.preprocessor_stdout == TRUE && Parse_Pass == PASS_1 )
@@ -0,0 +1,1256 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  "precompiled header" support ( cmdline option -Fp ).
+*               The state of the assembler after the files of the -Fi
+*               option have been processed in pass one is written to
+*               a file. If this file is valid, it's loaded by subsequent
+*               assembly runs instead of processing the -Fi files again.
+*               The state consists of the global symbol table ( equates,
+*               text macros, macros, types and struct fields, prototypes
+*               and externals ), the part of ModuleInfo that isn't in
+*               module_vars, and the renamed and disabled keywords.
+*               The file is an image of the objects, with pointers
+*               stored as offsets; a relocation table lists them.
+*
+****************************************************************************/
+
+#include <stddef.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#if defined(__UNIX__)
+    #include <unistd.h>
+#else
+    #include <direct.h>
+#endif
+#if defined(__UNIX__) && defined(__GNUC__)
+    #include <sys/mman.h>
+    #include <fcntl.h>
+#endif
+
+#include "globals.h"
+#include "memalloc.h"
+#include "parser.h"
+#include "input.h"
+#include "segment.h"
+#include "proc.h"
+#include "types.h"
+#include "assume.h"
+#include "condasm.h"
+#include "reswords.h"
+#include "fastpass.h"
+#include "pch.h"
+#include "objcache.h"
+
+#if PCHSUPP
+
+/* the version must be increased if the file format changes */
+#define PCH_VERSION 1
+
+#if AMD64_SUPPORT
+#define NUM_STDREGS 16
+#else
+#define NUM_STDREGS 8
+#endif
+
+#if defined(__UNIX__)
+#define GETCWD getcwd
+#else
+#define GETCWD _getcwd
+#endif
+
+#define TAILSIZE ( sizeof( struct module_info ) - sizeof( struct module_vars ) )
+
+extern int              MacroLocals;
+extern struct asym      *FileCur;
+extern struct asym      *symCurSeg;
+
+/* items in the PCH image. Pointers are stored as offsets,
+ * and relocated when the image has been loaded.
+ */
+struct pch_file {
+    char                *name;      /* file name as stored in FNames[] */
+    char                *guard;     /* multiple-include guard */
+    uint_32             size;       /* size of file */
+    uint_32             hash;       /* hash of file content */
+};
+
+struct pch_rename {
+    char                *name;      /* new name of keyword */
+    uint_16             token;
+    uint_8              len;
+};
+
+struct pch_header {
+    char                magic[8];
+    uint_32             version;
+    uint_32             layout;     /* hash of the assembler's data layout */
+    uint_32             options;    /* hash of the cmdline options */
+    uint_32             size;       /* size of image */
+    uint_32             relocs;     /* offset of relocation table */
+    uint_32             cntrelocs;  /* items in relocation table */
+    uint_32             cntpresyms; /* symbols in table before the -Fi files */
+    unsigned            firstfile;  /* index in FNames[] of first -Fi file */
+    unsigned            cntfiles;
+    unsigned            cntsyms;
+    unsigned            cntvars;
+    unsigned            cntdisabled;
+    unsigned            cntrenames;
+    int                 macrolocals;
+    unsigned            anonymous_label;
+    uint_8              replay;     /* lines of prelude are replayed in pass two */
+    int                 replaylocals;/* MacroLocals used by the replayed lines */
+    unsigned            replaylabels;/* anonymous labels of the replayed lines */
+    /* the following members are relocated */
+    struct pch_file     *files;     /* the files of the prelude */
+    struct asym         **syms;     /* symbols added to the global table */
+    struct asym         *vars;      /* new values of preexisting symbols */
+    struct dsym         *exthead;   /* SymTables[TAB_EXT] */
+    struct dsym         *exttail;
+    struct qitem        *libhead;   /* includelibs */
+    struct qitem        *libtail;
+    uint_8              *modinfo;   /* ModuleInfo without module_vars */
+    char                *prologue;
+    char                *epilogue;
+    uint_16             *disabled;  /* keywords disabled by OPTION NOKEYWORD */
+    struct pch_rename   *renames;   /* keywords renamed */
+    char                *echo;      /* output of ECHO */
+};
+
+static const char pch_magic[] = "JWASMPCH";
+
+/* hash table to map addresses of objects to their offset in the image
+ * or addresses of preexisting symbols to an index.
+ */
+struct map_item {
+    const void          *key;
+    uint_32             value;
+};
+
+struct ptr_map {
+    struct map_item     *table;
+    unsigned            size;       /* always a power of 2 */
+    unsigned            count;
+};
+
+/* a symbol that has been copied, but whose members are still to be handled */
+struct pend_item {
+    const struct asym   *sym;
+    uint_32             ofs;
+    bool                isfield;
+};
+
+struct assume_state {
+    struct assume_info  SegAssumeTable[NUM_SEGREGS];
+    struct assume_info  StdAssumeTable[NUM_STDREGS];
+    struct stdassume_typeinfo type_content[NUM_STDREGS];
+};
+
+/* state of the PCH writer. It's set by PchBegin() */
+static struct {
+    bool                active;
+    bool                failed;
+    uint_8              *image;
+    uint_32             size;
+    uint_32             max;
+    uint_32             *relocs;
+    uint_32             cntrelocs;
+    uint_32             maxrelocs;
+    struct pend_item    *pend;
+    unsigned            cntpend;
+    unsigned            maxpend;
+    struct ptr_map      map;        /* objects copied to the image */
+    struct ptr_map      pre;        /* preexisting symbols */
+    struct dsym         *presyms;   /* copies of preexisting symbols */
+    char                **prestrings;/* values of preexisting text macros */
+    unsigned            cntpre;
+    unsigned            firstfile;
+    struct module_vars  vars;
+    struct symbol_queue tables[TAB_LAST];
+    struct assume_state assumes;
+    struct global_options options;
+    uint_8              tail[TAILSIZE];
+    char                *echo;
+    unsigned            echolen;
+    unsigned            echomax;
+    int                 savedlocals;/* values when SaveState() was called */
+    unsigned            savedlabels;
+} wr;
+
+/* state of the PCH loader */
+static struct {
+    struct pch_header   *hdr;       /* the image; NULL if no PCH is loaded */
+    size_t              size;
+    bool                mapped;
+} ld;
+
+static uint_32 hashbytes( uint_32 h, const void *p, size_t size )
+/***************************************************************/
+{
+    const uint_8 *q = p;
+    /* FNV-1a */
+    for ( ; size; size--, q++ )
+        h = ( h ^ *q ) * 16777619;
+    return( h );
+}
+
+static uint_32 hashstr( uint_32 h, const char *s )
+/************************************************/
+{
+    return( s ? hashbytes( h, s, strlen( s ) + 1 ) : hashbytes( h, "", 1 ) );
+}
+
+/* the layout hash ensures that the file has been written by the very same
+ * jwasm binary.
+ */
+static uint_32 GetLayoutHash( void )
+/**********************************/
+{
+    static const uint_32 sizes[] = {
+        sizeof( void * ), sizeof( struct asym ), sizeof( struct dsym ), sizeof( struct sfield ),
+        sizeof( struct struct_info ), sizeof( struct macro_info ), sizeof( struct proc_info ),
+        sizeof( struct mparm_list ), sizeof( struct srcline ), sizeof( struct qitem ),
+        sizeof( struct module_info ), sizeof( struct module_vars ), sizeof( struct global_options ),
+        sizeof( struct pch_header ), _JWASM_VERSION_INT_ };
+    uint_32 h = 2166136261;
+
+    h = hashbytes( h, sizes, sizeof( sizes ) );
+    return( hashstr( h, __DATE__ " " __TIME__ ) );
+}
+
+/* the options hash covers everything that may change the result
+ * of the -Fi files: cmdline options, include paths, the current
+ * directory and the directory of the main source ( which is searched
+ * first for the -Fi files ).
+ */
+static uint_32 GetOptionsHash( void )
+/***********************************/
+{
+    struct global_options opts;
+    struct qitem *q;
+    const char *src;
+    uint_32 h = 2166136261;
+    int i;
+    char cwd[FILENAME_MAX];
+
+    memcpy( &opts, &Options, sizeof( opts ) );
+    memset( opts.names, 0, sizeof( opts.names ) );
+    memset( opts.queues, 0, sizeof( opts.queues ) );
+    opts.quiet = FALSE;
+    opts.error_limit = 0;
+    opts.no_error_disp = 0;
+#if OBJCACHE
+    opts.print_cache_stats = FALSE;
+#endif
+#if defined(__UNIX__)
+    opts.jobs = 0;
+    opts.fork_modules = FALSE;
+#endif
+    h = hashbytes( h, &opts, sizeof( opts ) );
+    for ( i = OPTN_MODULE_NAME; i < OPTN_LAST; i++ )
+        h = hashstr( h, Options.names[i] );
+    for ( i = 0; i < OPTQ_LAST; i++ )
+        for ( q = Options.queues[i]; q; q = q->next )
+            h = hashstr( h, q->value );
+    h = hashstr( h, ModuleInfo.g.IncludePath );
+    if ( GETCWD( cwd, sizeof( cwd ) ) == NULL )
+        cwd[0] = NULLC;
+    h = hashstr( h, cwd );
+    src = GetFName( ModuleInfo.srcfile )->fname;
+    return( hashbytes( h, src, GetFNamePart( src ) - src ) );
+}
+
+/* read a file and calculate its hash.
+ * if the text contains references to predefined text macros
+ * whose value depends on time, module or environment, the
+ * state cannot be saved.
+ */
+static bool GetFileHash( const char *name, uint_32 *psize, uint_32 *phash, bool scan )
+/************************************************************************************/
+{
+    static const char * const volatiles[] = { "@Date", "@Time", "@FileName", "@Environ" };
+    FILE *f;
+    char *buffer;
+    char *p;
+    char *end;
+    long size;
+    int i;
+    bool rc = TRUE;
+
+    if ( ( f = fopen( name, "rb" ) ) == NULL )
+        return( FALSE );
+    fseek( f, 0, SEEK_END );
+    size = ftell( f );
+    fseek( f, 0, SEEK_SET );
+    buffer = MemAlloc( size + 1 );
+    if ( size < 0 || fread( buffer, 1, size, f ) != size )
+        rc = FALSE;
+    fclose( f );
+    if ( rc ) {
+        *psize = size;
+        *phash = hashbytes( 2166136261, buffer, size );
+        buffer[size] = NULLC;
+        for ( p = buffer, end = buffer + size; scan && p < end; ) {
+            if ( *p == '@' && ( p == buffer || !is_valid_id_char( *(p-1) ) ) ) {
+                for ( i = 0; i < sizeof( volatiles ) / sizeof( volatiles[0] ); i++ ) {
+                    int len = strlen( volatiles[i] );
+                    if ( _memicmp( p, volatiles[i], len ) == 0 && !is_valid_id_char( *(p+len) ) ) {
+                        DebugMsg(("GetFileHash(%s): %s found\n", name, volatiles[i] ));
+                        rc = FALSE;
+                        break;
+                    }
+                }
+            }
+            p++;
+        }
+    }
+    MemFree( buffer );
+    return( rc );
+}
+
+/*
+ * the writer
+ */
+
+static void Fail( const char *reason, const char *name )
+/******************************************************/
+{
+    DebugMsg(("PCH: state cannot be saved: %s %s\n", reason, name ? name : "" ));
+    wr.failed = TRUE;
+}
+
+static void *Grow( void *p, unsigned itemsize, unsigned curr, unsigned *pmax )
+/****************************************************************************/
+{
+    void *newp;
+
+    *pmax = ( *pmax ? *pmax * 2 : 64 );
+    newp = MemAlloc( *pmax * itemsize );
+    if ( p ) {
+        memcpy( newp, p, curr * itemsize );
+        MemFree( p );
+    }
+    return( newp );
+}
+
+static unsigned MapIndex( const struct ptr_map *map, const void *key )
+/********************************************************************/
+{
+    size_t v = (size_t)key;
+    return( ( (uint_32)( v >> 3 ) * 2654435761U ) & ( map->size - 1 ) );
+}
+
+static uint_32 *MapFind( const struct ptr_map *map, const void *key )
+/*******************************************************************/
+{
+    unsigned i;
+
+    if ( map->size == 0 )
+        return( NULL );
+    for ( i = MapIndex( map, key ); map->table[i].key; i = ( i + 1 ) & ( map->size - 1 ) )
+        if ( map->table[i].key == key )
+            return( &map->table[i].value );
+    return( NULL );
+}
+
+static void MapAdd( struct ptr_map *map, const void *key, uint_32 value )
+/***********************************************************************/
+{
+    unsigned i;
+
+    if ( ( map->count + 1 ) * 2 > map->size ) {
+        struct map_item *old = map->table;
+        unsigned oldsize = map->size;
+        map->size = ( oldsize ? oldsize * 2 : 1024 );
+        map->table = MemAlloc( map->size * sizeof( struct map_item ) );
+        memset( map->table, 0, map->size * sizeof( struct map_item ) );
+        map->count = 0;
+        for ( i = 0; i < oldsize; i++ )
+            if ( old[i].key )
+                MapAdd( map, old[i].key, old[i].value );
+        if ( old )
+            MemFree( old );
+    }
+    for ( i = MapIndex( map, key ); map->table[i].key; i = ( i + 1 ) & ( map->size - 1 ) );
+    map->table[i].key = key;
+    map->table[i].value = value;
+    map->count++;
+}
+
+/* append data to the image; returns offset. If <p> is NULL, the space is cleared. */
+
+static uint_32 PutData( const void *p, uint_32 size )
+/***************************************************/
+{
+    uint_32 ofs = ( wr.size + 7 ) & ~7;
+
+    while ( ofs + size > wr.max ) {
+        uint_8 *newimg;
+        wr.max = ( wr.max ? wr.max * 2 : 0x10000 );
+        newimg = MemAlloc( wr.max );
+        if ( wr.image ) {
+            memcpy( newimg, wr.image, wr.size );
+            MemFree( wr.image );
+        }
+        wr.image = newimg;
+    }
+    memset( wr.image + wr.size, 0, ofs - wr.size );
+    if ( p )
+        memcpy( wr.image + ofs, p, size );
+    else
+        memset( wr.image + ofs, 0, size );
+    wr.size = ofs + size;
+    return( ofs );
+}
+
+/* set a pointer in the image. <target> is an offset, 0 is NULL */
+
+static void PutPtr( uint_32 slot, uint_32 target )
+/************************************************/
+{
+    *(size_t *)( wr.image + slot ) = target;
+    if ( target ) {
+        if ( wr.cntrelocs == wr.maxrelocs )
+            wr.relocs = Grow( wr.relocs, sizeof( uint_32 ), wr.cntrelocs, &wr.maxrelocs );
+        wr.relocs[wr.cntrelocs++] = slot;
+    }
+}
+
+/* copy a string; <min> is the minimal size of the buffer */
+
+static uint_32 PutString( const char *s, uint_32 min )
+/****************************************************/
+{
+    uint_32 len;
+    uint_32 ofs;
+
+    if ( s == NULL )
+        return( 0 );
+    len = strlen( s ) + 1;
+    ofs = PutData( NULL, len > min ? len : min );
+    memcpy( wr.image + ofs, s, len );
+    return( ofs );
+}
+
+/* get the offset of a symbol in the image. If it isn't copied yet,
+ * do it now; the members will be handled by PutSym().
+ */
+static uint_32 MapSym( const struct asym *sym, bool isfield )
+/***********************************************************/
+{
+    uint_32 *pofs;
+    uint_32 ofs;
+
+    if ( sym == NULL )
+        return( 0 );
+    if ( pofs = MapFind( &wr.map, sym ) )
+        return( *pofs );
+    if ( MapFind( &wr.pre, sym ) ) {
+        Fail( "reference to preexisting symbol", sym->name );
+        return( 0 );
+    }
+    if ( isfield )
+        ofs = PutData( sym, sizeof( struct sfield ) + strlen( ((struct sfield *)sym)->ivalue ) );
+    else
+        ofs = PutData( sym, sizeof( struct dsym ) );
+    MapAdd( &wr.map, sym, ofs );
+    if ( wr.cntpend == wr.maxpend )
+        wr.pend = Grow( wr.pend, sizeof( struct pend_item ), wr.cntpend, &wr.maxpend );
+    wr.pend[wr.cntpend].sym = sym;
+    wr.pend[wr.cntpend].ofs = ofs;
+    wr.pend[wr.cntpend].isfield = isfield;
+    wr.cntpend++;
+    return( ofs );
+}
+
+static void PutStructInfo( const struct struct_info *si, uint_32 slot )
+/*********************************************************************/
+{
+    uint_32 ofs;
+
+    if ( si == NULL ) {
+        PutPtr( slot, 0 );
+        return;
+    }
+    if ( si->isOpen ) {
+        Fail( "struct still open", NULL );
+        return;
+    }
+    ofs = PutData( si, sizeof( struct struct_info ) );
+    PutPtr( slot, ofs );
+    PutPtr( ofs + offsetof( struct struct_info, head ), MapSym( (struct asym *)si->head, TRUE ) );
+    PutPtr( ofs + offsetof( struct struct_info, tail ), MapSym( (struct asym *)si->tail, TRUE ) );
+#if STRUCTINDEX
+    /* the index is rebuilt by the first search */
+    PutPtr( ofs + offsetof( struct struct_info, index ), 0 );
+    ((struct struct_info *)( wr.image + ofs ))->isIndexed = FALSE;
+#endif
+}
+
+static void PutMacroInfo( const struct macro_info *mi, uint_32 slot )
+/*******************************************************************/
+{
+    uint_32 ofs;
+    uint_32 plofs;
+    const struct srcline *ln;
+    int i;
+
+    if ( mi == NULL ) {
+        PutPtr( slot, 0 );
+        return;
+    }
+    ofs = PutData( mi, sizeof( struct macro_info ) );
+    PutPtr( slot, ofs );
+    if ( mi->parmcnt && mi->parmlist ) {
+        plofs = PutData( mi->parmlist, mi->parmcnt * sizeof( struct mparm_list ) );
+        PutPtr( ofs + offsetof( struct macro_info, parmlist ), plofs );
+        for ( i = 0; i < mi->parmcnt; i++ )
+            PutPtr( plofs + i * sizeof( struct mparm_list ) + offsetof( struct mparm_list, deflt ),
+                   PutString( mi->parmlist[i].deflt, 0 ) );
+    } else
+        PutPtr( ofs + offsetof( struct macro_info, parmlist ), 0 );
+    slot = ofs + offsetof( struct macro_info, data );
+    for ( ln = mi->data; ln; ln = ln->next ) {
+        uint_32 lofs = PutData( ln, sizeof( struct srcline ) + strlen( ln->line ) );
+        PutPtr( slot, lofs );
+        slot = lofs + offsetof( struct srcline, next );
+    }
+    PutPtr( slot, 0 );
+}
+
+static void PutProcInfo( const struct proc_info *pi, uint_32 slot )
+/*****************************************************************/
+{
+    uint_32 ofs;
+
+    if ( pi == NULL ) {
+        PutPtr( slot, 0 );
+        return;
+    }
+    if ( pi->locallist || pi->localtab
+#if AMD64_SUPPORT
+        || pi->exc_handler
+#endif
+       ) {
+        Fail( "PROC found", NULL );
+        return;
+    }
+    ofs = PutData( pi, sizeof( struct proc_info ) );
+    PutPtr( slot, ofs );
+    PutPtr( ofs + offsetof( struct proc_info, regslist ),
+           pi->regslist ? PutData( pi->regslist, ( *pi->regslist + 1 ) * sizeof( uint_16 ) ) : 0 );
+    PutPtr( ofs + offsetof( struct proc_info, paralist ), MapSym( (struct asym *)pi->paralist, FALSE ) );
+    PutPtr( ofs + offsetof( struct proc_info, prologuearg ), PutString( pi->prologuearg, 0 ) );
+}
+
+/* handle the members of a symbol that has been copied to the image */
+
+static void PutSym( const struct asym *sym, uint_32 ofs, bool isfield )
+/*********************************************************************/
+{
+    const struct dsym *dir = (const struct dsym *)sym;
+
+    switch ( sym->state ) {
+    case SYM_UNDEFINED:
+    case SYM_SEG:
+    case SYM_GRP:
+    case SYM_ALIAS:
+    case SYM_CLASS_LNAME:
+        Fail( "invalid symbol type", sym->name );
+        return;
+    case SYM_INTERNAL:
+        /* just numeric equates and assembly-time variables */
+        if ( sym->isproc || sym->mem_type != MT_EMPTY ) {
+            Fail( "label or proc", sym->name );
+            return;
+        }
+        break;
+    }
+    if ( sym->segment || sym->bp_fixup || sym->predefined || sym->fwdref ) {
+        Fail( "unsupported symbol", sym->name );
+        return;
+    }
+
+    PutPtr( ofs + offsetof( struct asym, nextitem ), 0 );
+    PutPtr( ofs + offsetof( struct asym, name ), PutString( sym->name, 0 ) );
+    if ( sym->state == SYM_TMACRO )
+        PutPtr( ofs + offsetof( struct asym, string_ptr ), PutString( sym->string_ptr, sym->total_size ) );
+    if ( sym->state == SYM_EXTERNAL || sym->state == SYM_STACK ||
+        ( sym->state == SYM_TYPE && sym->typekind == TYPE_TYPEDEF ) )
+        PutPtr( ofs + offsetof( struct asym, target_type ), MapSym( sym->target_type, FALSE ) );
+    if ( sym->state == SYM_EXTERNAL && sym->iscomm == FALSE )
+        PutPtr( ofs + offsetof( struct asym, altname ), MapSym( sym->altname, FALSE ) );
+    PutPtr( ofs + offsetof( struct asym, type ), MapSym( sym->type, FALSE ) );
+#if FASTPASS
+    ((struct asym *)( wr.image + ofs ))->issaved = FALSE;
+#endif
+
+    if ( isfield ) {
+        PutPtr( ofs + offsetof( struct sfield, next ), MapSym( (struct asym *)((struct sfield *)sym)->next, TRUE ) );
+        return;
+    }
+    if ( sym->isproc )
+        PutProcInfo( dir->e.procinfo, ofs + offsetof( struct dsym, e ) );
+    else if ( sym->state == SYM_TYPE )
+        PutStructInfo( dir->e.structinfo, ofs + offsetof( struct dsym, e ) );
+    else if ( sym->state == SYM_MACRO )
+        PutMacroInfo( dir->e.macroinfo, ofs + offsetof( struct dsym, e ) );
+    else if ( dir->e.nextll ) {
+        Fail( "unsupported symbol extension", sym->name );
+        return;
+    }
+    PutPtr( ofs + offsetof( struct dsym, next ), MapSym( (struct asym *)dir->next, FALSE ) );
+    PutPtr( ofs + offsetof( struct dsym, prev ), MapSym( (struct asym *)dir->prev, FALSE ) );
+}
+
+/* check if the lines stored by FASTPASS during the prelude are harmless.
+ * Directives that are to be evaluated in pass two ( .ERRxx ) or generate code
+ * are rejected.
+ */
+static bool CheckLineStore( void )
+/********************************/
+{
+    struct line_item *curr;
+    const char *p;
+    const char *word;
+    unsigned token;
+    int i;
+
+    for ( curr = GetLineStore(); curr; curr = curr->next ) {
+        for ( p = curr->line, i = 0; i < 2; i++ ) {
+            while ( isspace( *p ) || *p == ':' )
+                p++;
+            for ( word = p; is_valid_id_char( *p ) || *p == '.'; p++ );
+            if ( p == word || p - word > MAX_ID_LEN )
+                break;
+            token = FindResWord( word, p - word );
+            if ( token && token < SPECIAL_LAST &&
+                SpecialTable[token].type == RWT_DIRECTIVE &&
+                ( GetValueSp( token ) & DF_STORE ) ) {
+                Fail( "directive in line store", curr->line );
+                return( FALSE );
+            }
+        }
+    }
+    return( TRUE );
+}
+
+/* check the preexisting symbols. Modified text macros and
+ * assembly-time variables are saved as "var updates".
+ */
+static uint_32 CheckPreSyms( unsigned *pcnt )
+/*******************************************/
+{
+    struct asym *sym;
+    struct asym *v;
+    struct asym tmp;
+    uint_32 *pidx;
+    uint_32 ofs = 0;
+    uint_32 vofs;
+    unsigned cnt = 0;
+    int i;
+
+    for ( sym = SymEnum( NULL, &i ); sym; sym = SymEnum( sym, &i ) ) {
+        const struct asym *old;
+        if ( ( pidx = MapFind( &wr.pre, sym ) ) == NULL )
+            continue;
+        old = &wr.presyms[*pidx].sym;
+        memcpy( &tmp, sym, sizeof( tmp ) );
+        tmp.referenced = old->referenced;
+        /* v2.21: the hash chains may have changed (new symbols, table grown) */
+        tmp.nextitem = old->nextitem;
+        if ( memcmp( &tmp, old, sizeof( tmp ) ) == 0 &&
+            ( sym->state != SYM_TMACRO || strcmp( sym->string_ptr ? sym->string_ptr : "", wr.prestrings[*pidx] ) == 0 ) )
+            continue;
+        if ( sym->predefined && ( sym == FileCur || ( sym->state == SYM_INTERNAL && sym->sfunc_ptr ) ) )
+            continue;
+        if ( memcmp( &((struct dsym *)sym)->e, &wr.presyms[*pidx].e, sizeof( struct dsym ) - sizeof( struct asym ) ) ) {
+            Fail( "preexisting symbol modified", sym->name );
+            return( 0 );
+        }
+        if ( sym->state == SYM_TMACRO && old->state == SYM_TMACRO )
+            ;
+        else if ( sym->state == SYM_INTERNAL && old->state == SYM_INTERNAL && sym->predefined == FALSE &&
+                 sym->segment == NULL && sym->isproc == FALSE && sym->type == NULL && sym->mem_type == MT_EMPTY )
+            ;
+        else {
+            Fail( "preexisting symbol modified", sym->name );
+            return( 0 );
+        }
+        DebugMsg(("PCH: var update %s\n", sym->name ));
+        vofs = PutData( sym, sizeof( struct asym ) );
+        if ( cnt == 0 )
+            ofs = vofs;
+        cnt++;
+        v = (struct asym *)( wr.image + vofs );
+        v->nextitem = NULL;
+#if FASTPASS
+        v->issaved = FALSE;
+#endif
+        PutPtr( vofs + offsetof( struct asym, name ), PutString( sym->name, 0 ) );
+        if ( sym->state == SYM_TMACRO )
+            PutPtr( vofs + offsetof( struct asym, string_ptr ), PutString( sym->string_ptr, sym->total_size ) );
+    }
+    *pcnt = cnt;
+    return( ofs );
+}
+
+/* compare the state with the state saved by PchBegin().
+ * Everything that can't be saved must be unchanged.
+ */
+static bool CheckState( void )
+/****************************/
+{
+    struct module_vars vars;
+    struct assume_state assumes;
+    const struct module_info *tail = (struct module_info *)( wr.tail - sizeof( struct module_vars ) );
+
+    memcpy( &vars, &ModuleInfo.g, sizeof( vars ) );
+    /* these members may change */
+    vars.FNames = wr.vars.FNames;
+    vars.cnt_fnames = wr.vars.cnt_fnames;
+    vars.LibQueue = wr.vars.LibQueue;
+    vars.src_stack = wr.vars.src_stack;
+    vars.line_queue = wr.vars.line_queue;
+    vars.HllFree = wr.vars.HllFree;
+    vars.ContextFree = wr.vars.ContextFree;
+#if FASTPASS
+    vars.SavedContexts = wr.vars.SavedContexts;
+    vars.cntSavedContexts = wr.vars.cntSavedContexts;
+#endif
+    vars.FixupHeap = wr.vars.FixupHeap;
+    vars.anonymous_label = wr.vars.anonymous_label;
+    if ( memcmp( &vars, &wr.vars, sizeof( vars ) ) ) {
+        Fail( "module state changed ( or errors/warnings )", NULL );
+        return( FALSE );
+    }
+    if ( memcmp( &Options, &wr.options, sizeof( Options ) ) ) {
+        Fail( "options changed", NULL );
+        return( FALSE );
+    }
+    if ( SymTables[TAB_UNDEF].head ||
+        memcmp( &SymTables[TAB_SEG], &wr.tables[TAB_SEG], sizeof( struct symbol_queue ) * ( TAB_LAST - TAB_SEG ) ) ) {
+        Fail( "undefined symbols, segments, groups or procs", NULL );
+        return( FALSE );
+    }
+    memset( &assumes, 0, sizeof( assumes ) );
+    GetSegAssumeTable( assumes.SegAssumeTable );
+    GetStdAssumeTable( assumes.StdAssumeTable, assumes.type_content );
+    if ( memcmp( &assumes, &wr.assumes, sizeof( assumes ) ) ) {
+        Fail( "ASSUME", NULL );
+        return( FALSE );
+    }
+    if ( CurrSeg != tail->currseg || ModuleInfo.fmtopt != tail->fmtopt ||
+#if DLLIMPORT
+        ModuleInfo.CurrDll != tail->CurrDll ||
+#endif
+        CurrStruct || CurrProc || ModuleInfo.EndDirFound || MacroLevel ||
+        ModuleInfo.inside_comment || GetIfNestLevel() || CurrIfState != BLOCK_ACTIVE ) {
+        Fail( "invalid state at end of prelude", NULL );
+        return( FALSE );
+    }
+    if ( StoreState && CheckLineStore() == FALSE )
+        return( FALSE );
+    return( TRUE );
+}
+
+static void FreeWriter( void )
+/****************************/
+{
+    unsigned i;
+
+    if ( wr.image ) MemFree( wr.image );
+    if ( wr.relocs ) MemFree( wr.relocs );
+    if ( wr.pend ) MemFree( wr.pend );
+    if ( wr.map.table ) MemFree( wr.map.table );
+    if ( wr.pre.table ) MemFree( wr.pre.table );
+    if ( wr.presyms ) MemFree( wr.presyms );
+    if ( wr.prestrings ) {
+        for ( i = 0; i < wr.cntpre; i++ )
+            if ( wr.prestrings[i] )
+                MemFree( wr.prestrings[i] );
+        MemFree( wr.prestrings );
+    }
+    if ( wr.echo ) MemFree( wr.echo );
+    memset( &wr, 0, sizeof( wr ) );
+}
+
+/* is PCH support active for the current module? */
+
+static bool PchEnabled( void )
+/****************************/
+{
+    return( Options.names[OPTN_PCH_FN] != NULL &&
+           Options.queues[OPTQ_FINCLUDE] != NULL &&
+           Options.write_listing == FALSE &&
+           Options.preprocessor_stdout == FALSE &&
+           Options.line_numbers == FALSE &&
+           Options.debug_symbols == 0
+#if defined(DEBUG_OUT) && FASTPASS
+           && Options.nofastpass == FALSE
+#endif
+          );
+}
+
+/* called in pass one before the -Fi files are processed,
+ * if no valid PCH has been loaded.
+ */
+void PchBegin( void )
+/*******************/
+{
+    struct asym *sym;
+    int i;
+    unsigned n;
+
+    if ( !PchEnabled() )
+        return;
+    FreeWriter();
+    if ( StoreState || ModuleInfo.g.LibQueue.head || SymTables[TAB_EXT].head || SymTables[TAB_UNDEF].head )
+        return;
+    DebugMsg(("PchBegin: saving state\n" ));
+    wr.active = TRUE;
+    wr.cntpre = SymGetCount();
+    wr.presyms = MemAlloc( ( wr.cntpre + 1 ) * sizeof( struct dsym ) );
+    wr.prestrings = MemAlloc( ( wr.cntpre + 1 ) * sizeof( char * ) );
+    for ( n = 0, sym = SymEnum( NULL, &i ); sym && n < wr.cntpre; sym = SymEnum( sym, &i ), n++ ) {
+        /* the preexisting symbols are all dsyms */
+        memcpy( &wr.presyms[n], sym, sizeof( struct dsym ) );
+        wr.prestrings[n] = NULL;
+        if ( sym->state == SYM_TMACRO ) {
+            const char *s = ( sym->string_ptr ? sym->string_ptr : "" );
+            wr.prestrings[n] = MemAlloc( strlen( s ) + 1 );
+            strcpy( wr.prestrings[n], s );
+        }
+        MapAdd( &wr.pre, sym, n );
+    }
+    wr.firstfile = ModuleInfo.g.cnt_fnames;
+    memcpy( &wr.vars, &ModuleInfo.g, sizeof( wr.vars ) );
+    memcpy( &wr.options, &Options, sizeof( wr.options ) );
+    memcpy( wr.tables, SymTables, sizeof( wr.tables ) );
+    memcpy( wr.tail, (uint_8 *)&ModuleInfo + sizeof( struct module_vars ), TAILSIZE );
+    GetSegAssumeTable( wr.assumes.SegAssumeTable );
+    GetStdAssumeTable( wr.assumes.StdAssumeTable, wr.assumes.type_content );
+}
+
+/* called by EchoDirective() in pass one */
+
+void PchEcho( const char *text )
+/******************************/
+{
+    unsigned len;
+
+    if ( wr.active ) {
+        len = strlen( text ) + 1;
+        while ( wr.echolen + len + 1 > wr.echomax )
+            wr.echo = Grow( wr.echo, 1, wr.echolen, &wr.echomax );
+        memcpy( wr.echo + wr.echolen, text, len - 1 );
+        wr.echolen += len;
+        wr.echo[wr.echolen-1] = '\n';
+        wr.echo[wr.echolen] = NULLC;
+    }
+}
+
+/* called in pass one after the -Fi files have been processed.
+ * Writes the PCH file if the state can be saved.
+ */
+void PchWrite( void )
+/*******************/
+{
+    struct pch_header *hdr;
+    struct asym *sym;
+    struct qitem *q;
+    uint_32 hofs;
+    uint_32 ofs;
+    uint_32 slot;
+    uint_32 cnt;
+    unsigned idx;
+    unsigned i;
+    int j;
+#if RENAMEKEY
+    void *node;
+#endif
+    FILE *f;
+    char *tmpname;
+    const char *name = Options.names[OPTN_PCH_FN];
+
+    if ( !wr.active )
+        return;
+    wr.active = FALSE;
+    if ( CheckState() == FALSE ) {
+        FreeWriter();
+        return;
+    }
+    SymCompleteAll(); /* v2.21: the image contains complete symbols only */
+    for ( sym = SymEnum( NULL, &j ); sym; sym = SymEnum( sym, &j ) )
+        if ( sym->fwdref && MapFind( &wr.pre, sym ) == NULL ) {
+            Fail( "forward reference", sym->name );
+            FreeWriter();
+            return;
+        }
+
+    hofs = PutData( NULL, sizeof( struct pch_header ) );
+    /* the new symbols of the global table */
+    for ( cnt = 0, sym = SymEnum( NULL, &j ); sym; sym = SymEnum( sym, &j ) )
+        if ( MapFind( &wr.pre, sym ) == NULL )
+            cnt++;
+    ofs = PutData( NULL, cnt * sizeof( void * ) );
+    PutPtr( hofs + offsetof( struct pch_header, syms ), cnt ? ofs : 0 );
+    for ( sym = SymEnum( NULL, &j ); sym; sym = SymEnum( sym, &j ) )
+        if ( MapFind( &wr.pre, sym ) == NULL ) {
+            /* record fields in the global table are sfields */
+            PutPtr( ofs, MapSym( sym, sym->state == SYM_STRUCT_FIELD && sym->mem_type == MT_BITS ) );
+            ofs += sizeof( void * );
+        }
+    ((struct pch_header *)wr.image)->cntsyms = cnt;
+    PutPtr( hofs + offsetof( struct pch_header, exthead ), MapSym( (struct asym *)SymTables[TAB_EXT].head, FALSE ) );
+    PutPtr( hofs + offsetof( struct pch_header, exttail ), MapSym( (struct asym *)SymTables[TAB_EXT].tail, FALSE ) );
+    /* handle all symbols that have been copied */
+    for ( idx = 0; idx < wr.cntpend && wr.failed == FALSE; idx++ )
+        PutSym( wr.pend[idx].sym, wr.pend[idx].ofs, wr.pend[idx].isfield );
+
+    ofs = CheckPreSyms( &i );
+    PutPtr( hofs + offsetof( struct pch_header, vars ), ofs );
+    ((struct pch_header *)wr.image)->cntvars = i;
+
+    /* the files of the prelude */
+    cnt = ModuleInfo.g.cnt_fnames - wr.firstfile;
+    ofs = PutData( NULL, cnt * sizeof( struct pch_file ) );
+    PutPtr( hofs + offsetof( struct pch_header, files ), cnt ? ofs : 0 );
+    for ( i = wr.firstfile; i < ModuleInfo.g.cnt_fnames && wr.failed == FALSE; i++, ofs += sizeof( struct pch_file ) ) {
+        struct pch_file *pf;
+        uint_32 size;
+        uint_32 hash;
+        if ( GetFileHash( ModuleInfo.g.FNames[i].fname, &size, &hash, TRUE ) == FALSE ) {
+            Fail( "file cannot be used", ModuleInfo.g.FNames[i].fname );
+            break;
+        }
+        PutPtr( ofs + offsetof( struct pch_file, name ), PutString( ModuleInfo.g.FNames[i].fname, 0 ) );
+        PutPtr( ofs + offsetof( struct pch_file, guard ), PutString( ModuleInfo.g.FNames[i].guard, 0 ) );
+        pf = (struct pch_file *)( wr.image + ofs );
+        pf->size = size;
+        pf->hash = hash;
+    }
+    ((struct pch_header *)wr.image)->cntfiles = cnt;
+
+    /* the includelibs */
+    slot = hofs + offsetof( struct pch_header, libhead );
+    for ( q = ModuleInfo.g.LibQueue.head, ofs = 0; q; q = q->next ) {
+        ofs = PutData( q, sizeof( struct qitem ) + strlen( q->value ) );
+        PutPtr( slot, ofs );
+        slot = ofs + offsetof( struct qitem, next );
+    }
+    PutPtr( slot, 0 );
+    PutPtr( hofs + offsetof( struct pch_header, libtail ), ofs );
+
+    /* the part of ModuleInfo which is saved by FASTPASS, too */
+    ofs = PutData( (uint_8 *)&ModuleInfo + sizeof( struct module_vars ), TAILSIZE );
+    PutPtr( hofs + offsetof( struct pch_header, modinfo ), ofs );
+    PutPtr( hofs + offsetof( struct pch_header, prologue ), PutString( ModuleInfo.proc_prologue, 0 ) );
+    PutPtr( hofs + offsetof( struct pch_header, epilogue ), PutString( ModuleInfo.proc_epilogue, 0 ) );
+
+    /* keywords disabled and renamed */
+    for ( cnt = 0, idx = GetDisabledKeyword( 0 ); idx; idx = GetDisabledKeyword( idx ), cnt++ );
+    ofs = PutData( NULL, cnt * sizeof( uint_16 ) );
+    PutPtr( hofs + offsetof( struct pch_header, disabled ), cnt ? ofs : 0 );
+    for ( idx = GetDisabledKeyword( 0 ); idx; idx = GetDisabledKeyword( idx ), ofs += sizeof( uint_16 ) )
+        *(uint_16 *)( wr.image + ofs ) = idx;
+    ((struct pch_header *)wr.image)->cntdisabled = cnt;
+
+#if RENAMEKEY
+    node = NULL;
+    for ( cnt = 0; GetRenamedKeyword( &node ); cnt++ );
+    ofs = PutData( NULL, cnt * sizeof( struct pch_rename ) );
+    PutPtr( hofs + offsetof( struct pch_header, renames ), cnt ? ofs : 0 );
+    for ( node = NULL; idx = GetRenamedKeyword( &node ); ofs += sizeof( struct pch_rename ) ) {
+        char buffer[256];
+        struct pch_rename *pr;
+        PutPtr( ofs + offsetof( struct pch_rename, name ), PutString( GetResWName( idx, buffer ), 0 ) );
+        pr = (struct pch_rename *)( wr.image + ofs );
+        pr->token = idx;
+        pr->len = strlen( buffer );
+    }
+    ((struct pch_header *)wr.image)->cntrenames = cnt;
+#endif
+
+    PutPtr( hofs + offsetof( struct pch_header, echo ), PutString( wr.echo, 0 ) );
+
+    if ( wr.failed ) {
+        FreeWriter();
+        return;
+    }
+
+    /* the relocation table */
+    ofs = PutData( wr.relocs, wr.cntrelocs * sizeof( uint_32 ) );
+
+    hdr = (struct pch_header *)wr.image;
+    memcpy( hdr->magic, pch_magic, sizeof( hdr->magic ) );
+    hdr->version = PCH_VERSION;
+    hdr->layout = GetLayoutHash();
+    hdr->options = GetOptionsHash();
+    hdr->size = wr.size;
+    hdr->relocs = ofs;
+    hdr->cntrelocs = wr.cntrelocs;
+    hdr->cntpresyms = wr.cntpre;
+    hdr->firstfile = wr.firstfile;
+    hdr->macrolocals = MacroLocals;
+    hdr->anonymous_label = ModuleInfo.g.anonymous_label;
+    if ( StoreState ) {
+        hdr->replay = TRUE;
+        hdr->replaylocals = MacroLocals - wr.savedlocals;
+        hdr->replaylabels = ModuleInfo.g.anonymous_label - wr.savedlabels;
+    }
+
+    /* write to a temporary file first, then rename it */
+    tmpname = MemAlloc( strlen( name ) + 16 );
+#if defined(__UNIX__)
+    /* v2.21: with -j, several processes may write the file */
+    sprintf( tmpname, "%s.%u", name, (unsigned)getpid() );
+#else
+    sprintf( tmpname, "%s.tmp", name );
+#endif
+    if ( f = fopen( tmpname, "wb" ) ) {
+        bool ok = ( fwrite( wr.image, 1, wr.size, f ) == wr.size );
+        if ( fclose( f ) == 0 && ok ) {
+            if ( rename( tmpname, name ) != 0 ) {
+                remove( name );
+                if ( rename( tmpname, name ) != 0 )
+                    remove( tmpname );
+            }
+            DebugMsg(("PchWrite: %s written, size=%u, symbols=%u, relocs=%u\n", name, wr.size, hdr->cntsyms, wr.cntrelocs ));
+        } else
+            remove( tmpname );
+    }
+    MemFree( tmpname );
+    FreeWriter();
+}
+
+/*
+ * the loader
+ */
+
+static void UnloadImage( void )
+/*****************************/
+{
+    if ( ld.hdr ) {
+#if defined(__UNIX__) && defined(__GNUC__)
+        if ( ld.mapped )
+            munmap( ld.hdr, ld.size );
+        else
+#endif
+            MemFree( ld.hdr );
+    }
+    memset( &ld, 0, sizeof( ld ) );
+}
+
+/* read or map the PCH file. The image must be writable, since it contains
+ * the symbols that will be used directly.
+ */
+static bool LoadImage( const char *name )
+/***************************************/
+{
+    struct stat st;
+#if defined(__UNIX__) && defined(__GNUC__)
+    int fd;
+    void *p;
+
+    if ( ( fd = open( name, O_RDONLY ) ) == -1 )
+        return( FALSE );
+    if ( fstat( fd, &st ) == -1 || st.st_size < sizeof( struct pch_header ) ) {
+        close( fd );
+        return( FALSE );
+    }
+    p = mmap( NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( p == MAP_FAILED )
+        return( FALSE );
+    ld.hdr = p;
+    ld.size = st.st_size;
+    ld.mapped = TRUE;
+#else
+    FILE *f;
+
+    if ( stat( name, &st ) == -1 || st.st_size < sizeof( struct pch_header ) )
+        return( FALSE );
+    if ( ( f = fopen( name, "rb" ) ) == NULL )
+        return( FALSE );
+    ld.hdr = MemAlloc( st.st_size );
+    ld.size = st.st_size;
+    if ( fread( ld.hdr, 1, st.st_size, f ) != st.st_size ) {
+        fclose( f );
+        UnloadImage();
+        return( FALSE );
+    }
+    fclose( f );
+#endif
+    return( TRUE );
+}
+
+/* called in pass one before the -Fi files are processed.
+ * returns TRUE if the state has been loaded from the PCH file.
+ */
+bool PchLoad( void )
+/******************/
+{
+    struct pch_header *hdr;
+    uint_8 *base;
+    uint_32 *reloc;
+    struct asym *sym;
+    unsigned i;
+    uint_32 size;
+    uint_32 hash;
+    const char *name = Options.names[OPTN_PCH_FN];
+    /* members of ModuleInfo that aren't restored */
+    struct module_info saved;
+
+    if ( !PchEnabled() || ld.hdr )
+        return( FALSE );
+    if ( StoreState || ModuleInfo.g.LibQueue.head || SymTables[TAB_EXT].head || SymTables[TAB_UNDEF].head )
+        return( FALSE );
+    if ( LoadImage( name ) == FALSE )
+        return( FALSE );
+
+    hdr = ld.hdr;
+    base = (uint_8 *)hdr;
+    if ( memcmp( hdr->magic, pch_magic, sizeof( hdr->magic ) ) ||
+        hdr->version != PCH_VERSION ||
+        hdr->layout != GetLayoutHash() ||
+        hdr->size != ld.size ||
+        hdr->relocs > hdr->size ||
+        hdr->cntrelocs > ( hdr->size - hdr->relocs ) / sizeof( uint_32 ) ||
+        hdr->options != GetOptionsHash() ||
+        hdr->cntpresyms != SymGetCount() ||
+        hdr->firstfile != ModuleInfo.g.cnt_fnames ) {
+        DebugMsg(("PchLoad: %s is invalid or outdated\n", name ));
+        UnloadImage();
+        return( FALSE );
+    }
+    for ( i = 0, reloc = (uint_32 *)( base + hdr->relocs ); i < hdr->cntrelocs; i++, reloc++ ) {
+        size_t *slot = (size_t *)( base + *reloc );
+        if ( *reloc > hdr->size - sizeof( size_t ) || *slot >= hdr->size ) {
+            UnloadImage();
+            return( FALSE );
+        }
+        *slot += (size_t)base;
+    }
+    /* check the content of the files */
+    for ( i = 0; i < hdr->cntfiles; i++ ) {
+        if ( GetFileHash( hdr->files[i].name, &size, &hash, FALSE ) == FALSE ||
+            size != hdr->files[i].size || hash != hdr->files[i].hash ) {
+            DebugMsg(("PchLoad: file %s has changed\n", hdr->files[i].name ));
+            UnloadImage();
+            return( FALSE );
+        }
+    }
+    DebugMsg(("PchLoad: loading %s, %u symbols\n", name, hdr->cntsyms ));
+
+    /* restore ModuleInfo. Members which describe the current
+     * module or line are kept.
+     */
+    memcpy( &saved, &ModuleInfo, sizeof( saved ) );
+    memcpy( (uint_8 *)&ModuleInfo + sizeof( struct module_vars ), hdr->modinfo, TAILSIZE );
+    ModuleInfo.proc_prologue = hdr->prologue;
+    ModuleInfo.proc_epilogue = hdr->epilogue;
+#if DLLIMPORT
+    ModuleInfo.CurrDll = saved.CurrDll;
+#endif
+    ModuleInfo.fmtopt = saved.fmtopt;
+    ModuleInfo.line_flags = saved.line_flags;
+    ModuleInfo.EndDirFound = saved.EndDirFound;
+    ModuleInfo.PhaseError = saved.PhaseError;
+    ModuleInfo.macro_level = saved.macro_level;
+    ModuleInfo.srcfile = saved.srcfile;
+    ModuleInfo.currseg = saved.currseg;
+    ModuleInfo.pCodeBuff = saved.pCodeBuff;
+    ModuleInfo.GeneratedCode = saved.GeneratedCode;
+    ModuleInfo.currsource = saved.currsource;
+    ModuleInfo.CurrComment = saved.CurrComment;
+    ModuleInfo.tokenarray = saved.tokenarray;
+    ModuleInfo.stringbufferend = saved.stringbufferend;
+    ModuleInfo.token_count = saved.token_count;
+    memcpy( ModuleInfo.name, saved.name, sizeof( ModuleInfo.name ) );
+    SetOfssize();
+    SymSetCmpFunc();
+
+    for ( i = 0; i < hdr->cntsyms; i++ )
+        SymAddGlobal( hdr->syms[i] );
+    SymTables[TAB_EXT].head = hdr->exthead;
+    SymTables[TAB_EXT].tail = hdr->exttail;
+    ModuleInfo.g.LibQueue.head = hdr->libhead;
+    ModuleInfo.g.LibQueue.tail = hdr->libtail;
+    for ( i = 0; i < hdr->cntfiles; i++ )
+        AddFileName( hdr->files[i].name, hdr->files[i].guard );
+
+    /* update preexisting text macros and variables */
+    for ( i = 0; i < hdr->cntvars; i++ ) {
+        if ( sym = SymSearch( hdr->vars[i].name ) ) {
+            struct asym tmp;
+            memcpy( &tmp, &hdr->vars[i], sizeof( tmp ) );
+            tmp.nextitem = sym->nextitem;
+            tmp.name = sym->name;
+            memcpy( sym, &tmp, sizeof( tmp ) );
+        }
+    }
+    for ( i = 0; i < hdr->cntdisabled; i++ )
+        DisableKeyword( hdr->disabled[i] );
+#if RENAMEKEY
+    /* the renames are undone at the end of pass one */
+    for ( i = 0; i < hdr->cntrenames; i++ )
+        RenameKeyword( hdr->renames[i].token, hdr->renames[i].name, hdr->renames[i].len );
+#endif
+    MacroLocals = hdr->macrolocals;
+    ModuleInfo.g.anonymous_label = hdr->anonymous_label;
+    if ( hdr->echo ) {
+        printf( "%s", hdr->echo );
+#if OBJCACHE
+        ObjCacheEcho( hdr->echo, FALSE );
+#endif
+    }
+    return( TRUE );
+}
+
+/* called by SaveState() if FASTPASS starts to store lines. */
+
+void PchSaveState( void )
+/***********************/
+{
+    if ( wr.active ) {
+        wr.savedlocals = MacroLocals;
+        wr.savedlabels = ModuleInfo.g.anonymous_label;
+    }
+}
+
+/* called in passes > 1 if the line store is used.
+ * If the storing of lines started inside the -Fi files,
+ * the stored lines of these files would be replayed now;
+ * simulate the effects that last beyond pass one.
+ */
+void PchPassInit( void )
+/**********************/
+{
+#if RENAMEKEY
+    unsigned i;
+#endif
+
+    if ( ld.hdr && ld.hdr->replay ) {
+        MacroLocals += ld.hdr->replaylocals;
+        ModuleInfo.g.anonymous_label += ld.hdr->replaylabels;
+#if RENAMEKEY
+        for ( i = 0; i < ld.hdr->cntrenames; i++ )
+            RenameKeyword( ld.hdr->renames[i].token, ld.hdr->renames[i].name, ld.hdr->renames[i].len );
+#endif
+    }
+}
+
+/* called once per module, after the symbols have been released */
+
+void PchFini( void )
+/******************/
+{
+    FreeWriter();
+    UnloadImage();
+}
+
+#endif
@@ -0,0 +1,292 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  read-ahead of source files ( cmdline option -Xr ).
+*               A thread reads the files that will be needed soon: the
+*               main source and the files named by INCLUDE and INCBIN
+*               directives. The names are found by input.c, which scans
+*               the content of a source file when it has been loaded.
+*               When the parser reaches such a directive, the content is
+*               taken from here, so the parser doesn't wait for the I/O.
+*               The thread runs while a module is assembled; it's
+*               terminated by PrefetchFini().
+*
+****************************************************************************/
+
+#include "globals.h"
+#include "prefetch.h"
+
+#if PREFETCH
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define PF_QUEUE_SIZE   64          /* max. number of pending requests */
+#define PF_MAXBYTES     0x4000000   /* max. size of content waiting to be used */
+#define PF_BLOCKSIZE    0x10000     /* size of blocks read for INCBIN files */
+
+enum pf_state {
+    PF_PENDING,     /* request is queued */
+    PF_READING,     /* thread is reading the file */
+    PF_DONE,        /* file has been read ( or could not be read ) */
+};
+
+/* a request. <paths> are the paths where the file is searched, in the
+ * order used by SearchFile(); each path is terminated by a NULLC,
+ * the list by an empty string.
+ */
+struct pf_item {
+    struct pf_item  *next;
+    uint_8          state;
+    bool            binary;     /* INCBIN file; content isn't kept */
+    const char      *found;     /* the path that has been opened */
+    char            *data;      /* file content ( C heap ) */
+    size_t          size;       /* size of content */
+    struct stat     st;         /* file status when it was read */
+    char            paths[1];
+};
+
+static pthread_mutex_t  pf_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   pf_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t        pf_thread;
+static bool             pf_running; /* thread has been created */
+static bool             pf_stop;    /* thread is to terminate */
+static struct pf_item   *pf_head;   /* requests, in order of arrival */
+static struct pf_item   *pf_tail;
+static unsigned         pf_pending; /* number of items with state PF_PENDING */
+static size_t           pf_bytes;   /* size of content of PF_DONE items */
+
+/* read a file into the C heap. returns the number of bytes read or -1.
+ * the content of INCBIN files is read in blocks and discarded, just
+ * to have it in the OS cache when the parser needs it.
+ */
+static ssize_t ReadContent( int fd, struct pf_item *item )
+/********************************************************/
+{
+    char    *p;
+    size_t  max;
+    size_t  cnt;
+    ssize_t rc;
+
+    if ( item->binary ) {
+        if ( ( p = malloc( PF_BLOCKSIZE ) ) == NULL )
+            return( -1 );
+        for ( cnt = 0; ( rc = read( fd, p, PF_BLOCKSIZE ) ) > 0; cnt += rc );
+        free( p );
+        return( rc < 0 ? -1 : cnt );
+    }
+    max = ( item->st.st_size ? item->st.st_size : 1 );
+    if ( ( p = malloc( max ) ) == NULL )
+        return( -1 );
+    for ( cnt = 0; cnt < max; cnt += rc ) {
+        if ( ( rc = read( fd, p + cnt, max - cnt ) ) <= 0 )
+            break;
+    }
+    /* if the file has been changed, the parser will read it */
+    if ( cnt != item->st.st_size ) {
+        free( p );
+        return( -1 );
+    }
+    item->data = p;
+    return( cnt );
+}
+
+/* process a request: open the first path that exists and read it */
+
+static void ReadItem( struct pf_item *item )
+/******************************************/
+{
+    const char *path;
+    int fd;
+
+    for ( path = item->paths; *path; path += strlen( path ) + 1 ) {
+        if ( ( fd = open( path, O_RDONLY ) ) == -1 )
+            continue;
+        item->found = path;
+        if ( fstat( fd, &item->st ) == 0 && S_ISREG( item->st.st_mode ) ) {
+            pthread_mutex_lock( &pf_mutex );
+            if ( item->binary || pf_bytes + item->st.st_size <= PF_MAXBYTES ) {
+                /* reserve the space; it's released by the main thread */
+                if ( !item->binary )
+                    pf_bytes += item->st.st_size;
+                pthread_mutex_unlock( &pf_mutex );
+                if ( ReadContent( fd, item ) == -1 && !item->binary ) {
+                    pthread_mutex_lock( &pf_mutex );
+                    pf_bytes -= item->st.st_size;
+                    pthread_mutex_unlock( &pf_mutex );
+                }
+            } else
+                pthread_mutex_unlock( &pf_mutex );
+        }
+        close( fd );
+        break;
+    }
+}
+
+static void *PrefetchThread( void *arg )
+/**************************************/
+{
+    struct pf_item *item;
+
+    pthread_mutex_lock( &pf_mutex );
+    for ( ;; ) {
+        for ( item = pf_head; item && item->state != PF_PENDING; item = item->next );
+        if ( item == NULL ) {
+            if ( pf_stop )
+                break;
+            pthread_cond_wait( &pf_cond, &pf_mutex );
+            continue;
+        }
+        item->state = PF_READING;
+        pf_pending--;
+        pthread_mutex_unlock( &pf_mutex );
+        ReadItem( item );
+        pthread_mutex_lock( &pf_mutex );
+        item->state = PF_DONE;
+        pthread_cond_broadcast( &pf_cond );
+    }
+    pthread_mutex_unlock( &pf_mutex );
+    return( NULL );
+}
+
+/* does the path list of an item contain <path>? */
+
+static bool HasPath( const struct pf_item *item, const char *path )
+/*****************************************************************/
+{
+    const char *p;
+
+    for ( p = item->paths; *p; p += strlen( p ) + 1 )
+        if ( strcmp( p, path ) == 0 )
+            return( TRUE );
+    return( FALSE );
+}
+
+static void FreeItem( struct pf_item *item )
+/******************************************/
+{
+    if ( item->data ) {
+        free( item->data );
+        pf_bytes -= item->st.st_size;
+    }
+    free( item );
+}
+
+/* queue a request. it's just a hint, so it's silently dropped if
+ * the queue is full or the thread cannot be created.
+ * paths: paths to try, each terminated by a NULLC; size: total size.
+ */
+void PrefetchFile( const char *paths, unsigned size, bool binary )
+/****************************************************************/
+{
+    struct pf_item *item;
+
+    if ( Options.read_ahead == FALSE || Options.fork_modules )
+        return;
+    pthread_mutex_lock( &pf_mutex );
+    for ( item = pf_head; item; item = item->next )
+        if ( HasPath( item, paths ) )
+            break;
+    if ( item == NULL && pf_pending < PF_QUEUE_SIZE &&
+        ( item = malloc( sizeof( struct pf_item ) + size ) ) ) {
+        memset( item, 0, sizeof( struct pf_item ) );
+        item->binary = binary;
+        memcpy( item->paths, paths, size );
+        item->paths[size] = NULLC;
+        if ( pf_running == FALSE ) {
+            pf_stop = FALSE;
+            if ( pthread_create( &pf_thread, NULL, PrefetchThread, NULL ) == 0 )
+                pf_running = TRUE;
+        }
+        if ( pf_running ) {
+            DebugMsg1(("PrefetchFile(%s): request queued\n", paths ));
+            if ( pf_tail )
+                pf_tail->next = item;
+            else
+                pf_head = item;
+            pf_tail = item;
+            pf_pending++;
+            pthread_cond_broadcast( &pf_cond );
+        } else
+            free( item );
+    }
+    pthread_mutex_unlock( &pf_mutex );
+}
+
+/* get the content of a file that has been read ahead.
+ * the file has been opened by the caller; its status must match.
+ * returns a buffer in the C heap - or NULL, then the caller reads the file.
+ */
+char *PrefetchGet( const char *path, const struct stat *st, size_t *psize )
+/*************************************************************************/
+{
+    struct pf_item *item;
+    struct pf_item **pitem;
+    struct pf_item *prev = NULL;
+    char *data = NULL;
+
+    if ( pf_running == FALSE )
+        return( NULL );
+    pthread_mutex_lock( &pf_mutex );
+    for ( pitem = &pf_head; *pitem; prev = *pitem, pitem = &(*pitem)->next )
+        if ( HasPath( *pitem, path ) )
+            break;
+    if ( item = *pitem ) {
+        /* if the thread is reading the file, wait; it's faster than to start again */
+        while ( item->state == PF_READING )
+            pthread_cond_wait( &pf_cond, &pf_mutex );
+        if ( item->state == PF_PENDING )
+            pf_pending--;
+        else if ( item->data && strcmp( item->found, path ) == 0 &&
+                 item->st.st_mtime == st->st_mtime && item->st.st_size == st->st_size &&
+                 item->st.st_dev == st->st_dev && item->st.st_ino == st->st_ino ) {
+            DebugMsg1(("PrefetchGet(%s): content found, size=%u\n", path, (unsigned)item->st.st_size ));
+            data = item->data;
+            *psize = item->st.st_size;
+            pf_bytes -= item->st.st_size;
+            item->data = NULL;
+        }
+        /* the item is removed in any case */
+        *pitem = item->next;
+        if ( pf_tail == item )
+            pf_tail = prev;
+        FreeItem( item );
+    }
+    pthread_mutex_unlock( &pf_mutex );
+    return( data );
+}
+
+/* terminate the thread and release the requests; called at module end */
+
+void PrefetchFini( void )
+/***********************/
+{
+    struct pf_item *item;
+
+    if ( pf_running == FALSE )
+        return;
+    pthread_mutex_lock( &pf_mutex );
+    /* pending requests are dropped */
+    for ( item = pf_head; item; item = item->next )
+        if ( item->state == PF_PENDING )
+            item->state = PF_DONE;
+    pf_pending = 0;
+    pf_stop = TRUE;
+    pthread_cond_broadcast( &pf_cond );
+    pthread_mutex_unlock( &pf_mutex );
+    pthread_join( pf_thread, NULL );
+    pf_running = FALSE;
+    DebugMsg(("PrefetchFini: unused content=%u\n", (unsigned)pf_bytes ));
+    while ( item = pf_head ) {
+        pf_head = item->next;
+        FreeItem( item );
+    }
+    pf_tail = NULL;
+}
+
+#endif
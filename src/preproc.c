@@ -167,10 +167,21 @@ int PreprocessLine( char *line, struct asm_tok tokenarray[] )
              * handle it in ANY case and if it defines a number, the line
              * must be stored and, if -EP is set, written to stdout.
              */
+#if EQUTABLE
+            /* v2.21: a new constant may just be added to the compact table */
+            if ( AddCompactConstant( tokenarray ) ) {
+                if ( Options.preprocessor_stdout == TRUE )
+                    WritePreprocessedLine( line );
+                return( 0 );
+            }
+#endif
             if ( sym = CreateConstant( tokenarray ) ) {
                 if ( sym->state != SYM_TMACRO ) {
 #if FASTPASS
                     if ( StoreState ) FStoreLine( FSL_NOCMT );
+#endif
+#if INVLINES
+                    InvLineEqu( sym );
 #endif
                     if ( Options.preprocessor_stdout == TRUE )
                         WritePreprocessedLine( line );
@@ -409,8 +409,6 @@ void *peekitem( void *stk, int level )
 static void push_proc( struct dsym *proc )
 /****************************************/
 {
-    if ( Parse_Pass == PASS_1 ) /* get the locals stored so far */
-        SymGetLocal( (struct asym *)proc );
     pushitem( &ProcStack, proc );
     return;
 }
@@ -1352,7 +1350,7 @@ struct asym *CreateProc( struct asym *sym, const char *name, enum sym_state stat
         info->regslist = NULL;
         info->paralist = NULL;
         info->locallist = NULL;
-        info->labellist = NULL;
+        info->localtab = NULL;
         info->parasize = 0;
         info->localsize = 0;
         info->prologuearg = NULL;
@@ -1390,16 +1388,21 @@ void DeleteProc( struct dsym *proc )
 {
     struct dsym *curr;
     struct dsym *next;
+    int i;
 
     DebugMsg(("DeleteProc(%s) enter\n", proc->sym.name ));
     if ( proc->sym.state == SYM_INTERNAL ) {
 
         /* delete all local symbols ( params, locals, labels ) */
-        for( curr = proc->e.procinfo->labellist; curr; ) {
-            next = curr->e.nextll;
-            DebugMsg(("DeleteProc(%s): free %s [next=%p]\n", proc->sym.name, curr->sym.name, curr->next ));
-            SymFree( &curr->sym );
-            curr = next;
+        if ( proc->e.procinfo->localtab ) {
+            for ( i = 0; i < LHASH_TABLE_SIZE; i++ )
+                for( curr = (struct dsym *)proc->e.procinfo->localtab[i]; curr; ) {
+                    next = (struct dsym *)curr->sym.nextitem;
+                    DebugMsg(("DeleteProc(%s): free %s [next=%p]\n", proc->sym.name, curr->sym.name, next ));
+                    SymFree( &curr->sym );
+                    curr = next;
+                }
+            LclFree( proc->e.procinfo->localtab );
         }
 
         if ( proc->e.procinfo->regslist )
@@ -1829,13 +1832,9 @@ static void ProcFini( struct dsym *proc )
 #endif
     if ( ModuleInfo.list ) LstWrite( LSTTYPE_LABEL, 0, NULL );
 
-    /* create the list of locals */
-    if ( Parse_Pass == PASS_1 ) {
-        /* in case the procedure is empty, init addresses of local variables ( for proper listing ) */
-        if( ProcStatus & PRST_PROLOGUE_NOT_DONE )
-            SetLocalOffsets( CurrProc->e.procinfo );
-        SymGetLocal( (struct asym *)CurrProc );
-    }
+    /* in case the procedure is empty, init addresses of local variables ( for proper listing ) */
+    if ( Parse_Pass == PASS_1 && ( ProcStatus & PRST_PROLOGUE_NOT_DONE ) )
+        SetLocalOffsets( CurrProc->e.procinfo );
 
     CurrProc = pop_proc();
     if ( CurrProc )
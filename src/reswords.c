@@ -19,12 +19,29 @@
 #include "i86.h"
 #endif
 
-//#define HASH_TABITEMS 211
-#if AVXSUPP
-#define HASH_TABITEMS 811
-#else
-#define HASH_TABITEMS 599
-#endif
+/* v2.21: the reserved words are found with a perfect hash. The static table,
+ * perf_table[], contains all reserved words with their original names. It's
+ * generated at build time by mkreswh ( see GccUnix.mak ) - if reswh.h isn't
+ * available, the table is created by ResWordsInit(). resw_table[] is a small
+ * overlay for the words that aren't in the static table: renamed keywords and
+ * names that occur twice ( SYSCALL ). Disabled words and the words not valid
+ * in the current mode ( IA32 or x64 ) are marked with RWF_HIDDEN.
+ */
+#define HASH_TABITEMS 211
+
+#define PH_SLOTBITS   11
+#define PH_BUCKETBITS 9
+#define PH_SLOTS      ( 1 << PH_SLOTBITS )
+#define PH_BUCKETS    ( 1 << PH_BUCKETBITS )
+
+/* bucket and slot index from the hash value of a name */
+#define PH_BUCKET( h )  ( (h) >> ( 32 - PH_BUCKETBITS ) )
+#define PH_SLOT( h, d ) ( (uint_32)( ( (h) ^ (d) ) * 0x9E3779B1 ) >> ( 32 - PH_SLOTBITS ) )
+
+struct perf_item {
+    uint_16 token; /* 0 = slot is free */
+    uint_8  len;   /* length of the word */
+};
 
 #if 0 // def __I86__
 /* optionally, for JWASMR, use a void based pointer for the name field.
@@ -36,7 +53,7 @@
 #define GetPtr( x, y ) x->y
 #endif
 
-/* reserved words hash table */
+/* reserved words overlay hash table */
 static uint_16 resw_table[ HASH_TABITEMS ];
 
 /* define unary operand (LOW, HIGH, OFFSET, ...) type flags */
@@ -343,6 +360,17 @@ const uint_8 vex_flags[] = {
 };
 #endif
 
+#ifdef RESWH
+#include "reswh.h" /* perf_disp[] and perf_table[], created by mkreswh */
+#else
+static uint_16 perf_disp[PH_BUCKETS];
+static struct perf_item perf_table[PH_SLOTS];
+#endif
+
+/* is the word in the static table, with its original name? */
+#define IsStatic( token ) ( ( ResWordTable[token].flags & RWF_STATIC ) && \
+    ResWordTable[token].name >= resw_strings && ResWordTable[token].name < strSyscall_ )
+
 #if AMD64_SUPPORT
 
 /* keywords to be added for 64-bit */
@@ -412,33 +440,169 @@ static struct {
 static bool  b64bit = FALSE; /* resw tables in 64bit mode? */
 #endif
 
-static unsigned get_hash( const char *s, unsigned char size )
-/***********************************************************/
+/* v2.21: case-insensitive hash of a name; or'ing 0x20 into each byte
+ * folds the case. The name is processed 4 bytes at a time.
+ * The same value is used for the reserved words, the symbol tables
+ * and the struct members; the tokenizer stores it in T_ID tokens.
+ * The static table uses all 32 bits, the overlay the remainder of
+ * HASH_TABITEMS.
+ */
+uint_32 GetNameHash( const char *s, unsigned size )
+/*************************************************/
+{
+    const unsigned char *p = (const unsigned char *)s;
+    uint_32 h = size;
+
+    for( ; size >= 4; size -= 4, p += 4 ) {
+        h = ( ( h << 5 ) | ( h >> 27 ) ) ^ ( ( p[0] | ( p[1] << 8 ) | ( (uint_32)p[2] << 16 ) | ( (uint_32)p[3] << 24 ) ) | 0x20202020 );
+        h *= 0x9E3779B1;
+    }
+    for( ; size; size--, p++ ) {
+        h = ( ( h << 5 ) | ( h >> 27 ) ) ^ ( *p | ' ' );
+        h *= 0x9E3779B1;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    return( h );
+}
+
+#ifndef RESWH
+
+/* v2.21: create the static table ( "hash and displace" ).
+ * The words are distributed to PH_BUCKETS buckets. Starting with the
+ * largest bucket, for each bucket a displacement value is searched that
+ * moves all its words to free slots. A word whose name occurs twice or
+ * that can't be placed isn't contained in the table.
+ */
+static void MakePerfHash( void )
+/******************************/
+{
+    unsigned num = sizeof( ResWordTable ) / sizeof( ResWordTable[0] );
+    uint_32 *hash;
+    uint_16 *next;
+    uint_16 head[PH_BUCKETS];
+    uint_8  cnt[PH_BUCKETS];
+    unsigned i;
+    unsigned j;
+    unsigned b;
+    unsigned d;
+    unsigned max;
+
+    hash = malloc( num * ( sizeof( uint_32 ) + sizeof( uint_16 ) ) );
+    next = (uint_16 *)( hash + num );
+    memset( head, 0, sizeof( head ) );
+    memset( cnt, 0, sizeof( cnt ) );
+
+    /* the words of a bucket are sorted by token value */
+    for( i = num - 1; i; i-- ) {
+        hash[i] = GetNameHash( ResWordTable[i].name, ResWordTable[i].len );
+        b = PH_BUCKET( hash[i] );
+        next[i] = head[b];
+        head[b] = i;
+    }
+    /* if a name occurs twice, the first word wins */
+    for( b = 0, max = 0; b < PH_BUCKETS; b++ ) {
+        for( i = head[b]; i; i = next[i], cnt[b]++ )
+            for( j = i; next[j]; )
+                if ( hash[next[j]] == hash[i] && ResWordTable[next[j]].len == ResWordTable[i].len &&
+                    _memicmp( ResWordTable[next[j]].name, ResWordTable[i].name, ResWordTable[i].len ) == 0 )
+                    next[j] = next[next[j]];
+                else
+                    j = next[j];
+        if ( cnt[b] > max )
+            max = cnt[b];
+    }
+
+    for( ; max; max-- ) {
+        for( b = 0; b < PH_BUCKETS; b++ ) {
+            if ( cnt[b] != max )
+                continue;
+            for( d = 0; d < 0x10000; d++ ) {
+                for( i = head[b]; i; i = next[i] ) {
+                    if ( perf_table[ PH_SLOT( hash[i], d ) ].token )
+                        break;
+                    perf_table[ PH_SLOT( hash[i], d ) ].token = i;
+                }
+                if ( i == 0 )
+                    break;
+                for( j = head[b]; j != i; j = next[j] )
+                    perf_table[ PH_SLOT( hash[j], d ) ].token = 0;
+            }
+            if ( d < 0x10000 ) {
+                perf_disp[b] = d;
+                for( i = head[b]; i; i = next[i] )
+                    perf_table[ PH_SLOT( hash[i], d ) ].len = ResWordTable[i].len;
+            } else {
+                DebugMsg(("MakePerfHash: bucket %u not placed\n", b ));
+            }
+        }
+    }
+    free( hash );
+}
+
+#endif
+
+#ifdef MKRESWH
+
+/* v2.21: mkreswh: write the static table to stdout */
+
+int main( void )
+/**************/
 {
-    uint_32 h;
-    uint_32 g;
-
-    for( h = 0; size; size-- ) {
-        /* ( h & ~0x0fff ) == 0 is always true here */
-        h = (h << 3) + (*s++ | ' ');
-        g = h & ~0x1fff;
-        h ^= g;
-        h ^= g >> 13;
+    unsigned i;
+    const char *p = resw_strings;
+
+    for( i = 1; i < sizeof( ResWordTable ) / sizeof( ResWordTable[0] ); i++ ) {
+        ResWordTable[i].name = p;
+        p += ResWordTable[i].len;
     }
-    return( h % HASH_TABITEMS );
+    MakePerfHash();
+
+    printf( "/* generated by mkreswh - do not edit */\n\n" );
+    printf( "#if PH_SLOTBITS != %u || PH_BUCKETBITS != %u\n", PH_SLOTBITS, PH_BUCKETBITS );
+    printf( "#error reswh.h is outdated\n#endif\n\n" );
+    printf( "/* fails if ResWordTable[] has changed */\n" );
+    printf( "typedef char reswh_check[ ( sizeof( ResWordTable ) / sizeof( ResWordTable[0] ) == %u ) ? 1 : -1 ];\n\n",
+           (unsigned)( sizeof( ResWordTable ) / sizeof( ResWordTable[0] ) ) );
+    printf( "static const uint_16 perf_disp[PH_BUCKETS] = {" );
+    for( i = 0; i < PH_BUCKETS; i++ )
+        printf( "%s%u,", ( i % 16 ) ? "" : "\n", perf_disp[i] );
+    printf( "\n};\n\nstatic const struct perf_item perf_table[PH_SLOTS] = {" );
+    for( i = 0; i < PH_SLOTS; i++ )
+        printf( "%s{%u,%u},", ( i % 8 ) ? "" : "\n", perf_table[i].token, perf_table[i].len );
+    printf( "\n};\n" );
+    return( 0 );
 }
 
+#else
+
 unsigned FindResWord( const char *name, unsigned char size )
 /**********************************************************/
-/* search reserved word in hash table */
+{
+    return( FindResWordHash( name, size, GetNameHash( name, size ) ) );
+}
+
+/* search reserved word in hash table.
+ * v2.21: hash value supplied by caller ( see get_id() ).
+ */
+unsigned FindResWordHash( const char *name, unsigned char size, uint_32 h )
+/*************************************************************************/
 {
     struct ReservedWord *inst;
     unsigned i;
+    const struct perf_item *pi = &perf_table[ PH_SLOT( h, perf_disp[ PH_BUCKET( h ) ] ) ];
 #ifdef BASEPTR
     __segment seg = FP_SEG( resw_strings );
 #endif
 
-    for( i = resw_table[ get_hash( name, size ) ]; i != 0; i = inst->next ) {
+    /* v2.21: one probe into the static table */
+    if ( pi->len == size ) {
+        inst = &ResWordTable[pi->token];
+        if ( !( inst->flags & RWF_HIDDEN ) && _memicmp( name, GetPtr( inst, name ), size ) == 0 )
+            return( pi->token );
+    }
+    for( i = resw_table[ h % HASH_TABITEMS ]; i != 0; i = inst->next ) {
         inst = &ResWordTable[i];
         /* check if the name matches the entry for this inst in AsmChars */
         //if( name[ inst->len ] == NULLC && _strnicmp( name, inst->name, inst->len ) == 0) {
@@ -449,7 +613,10 @@ unsigned FindResWord( const char *name, unsigned char size )
     return( 0 );
 }
 
-/* add reserved word to hash table */
+/* add reserved word to hash table.
+ * v2.21: a word of the static table just gets visible;
+ * other words are added to the overlay.
+ */
 
 static void AddResWord( int token )
 /*********************************/
@@ -461,7 +628,11 @@ static void AddResWord( int token )
     __segment seg = FP_SEG( resw_strings );
 #endif
 
-    i = get_hash( ResWordTable[token].name, ResWordTable[token].len );
+    if ( IsStatic( token ) ) {
+        ResWordTable[token].flags &= ~RWF_HIDDEN;
+        return;
+    }
+    i = GetNameHash( ResWordTable[token].name, ResWordTable[token].len ) % HASH_TABITEMS;
 
     /* sort the items of a line by length! */
 
@@ -490,7 +661,13 @@ static int RemoveResWord( int token )
     __segment seg = FP_SEG( resw_strings );
 #endif
 
-    i = get_hash( ResWordTable[token].name, ResWordTable[token].len );
+    if ( IsStatic( token ) ) {
+        if ( ResWordTable[token].flags & RWF_HIDDEN )
+            return( FALSE );
+        ResWordTable[token].flags |= RWF_HIDDEN;
+        return( TRUE );
+    }
+    i = GetNameHash( ResWordTable[token].name, ResWordTable[token].len ) % HASH_TABITEMS;
 
     for( curr = resw_table[i], old = 0 ; curr != 0 ; old = curr, curr = ResWordTable[curr].next )  {
         if( curr == token ) {
@@ -677,6 +854,33 @@ bool IsKeywordDisabled( const char *name, int len )
     return( FALSE );
 }
 
+#if PCHSUPP
+
+/* v2.21: enumerate disabled keywords; used by -Fp.
+ * token 0 starts the enumeration, 0 is returned at the end.
+ */
+unsigned GetDisabledKeyword( unsigned token )
+/*******************************************/
+{
+    return( token ? ResWordTable[token].next : Removed.Head );
+}
+
+#if RENAMEKEY
+/* v2.21: enumerate renamed keywords; used by -Fp.
+ * *pnode must be NULL initially, 0 is returned at the end.
+ */
+unsigned GetRenamedKeyword( void **pnode )
+/****************************************/
+{
+    struct rename_node *curr = ( *pnode ? ((struct rename_node *)*pnode)->next : renamed_keys.head );
+
+    *pnode = curr;
+    return( curr ? curr->token : 0 );
+}
+#endif
+
+#endif
+
 /* get current name of a reserved word.
  * max size is 255.
  */
@@ -723,12 +927,24 @@ void ResWordsInit( void )
 #endif
 
     /* initialize ResWordTable[].name and .len.
-     * add keyword to hash table ( unless it is 64-bit only ).
      * v2.09: start with index = 1, since index 0 is now T_NULL
      */
     for( i = 1; i < sizeof( ResWordTable ) / sizeof( ResWordTable[0] ); i++ ) {
         ResWordTable[i].name = p;
         p += ResWordTable[i].len;
+        ResWordTable[i].flags |= RWF_HIDDEN;
+    }
+#ifndef RESWH
+    MakePerfHash();
+#endif
+    for( i = 0; i < PH_SLOTS; i++ )
+        ResWordTable[perf_table[i].token].flags |= RWF_STATIC;
+    ResWordTable[0].flags = 0;
+
+    /* add keyword to hash table ( unless it is 64-bit only ).
+     * v2.21: for words in the static table, this just clears RWF_HIDDEN.
+     */
+    for( i = 1; i < sizeof( ResWordTable ) / sizeof( ResWordTable[0] ); i++ ) {
 #if AMD64_SUPPORT /* don't add the words specific to x64 */
         if ( !(ResWordTable[i].flags & RWF_X64 ) )
 #endif
@@ -868,8 +1084,14 @@ void DumpInstrStats( void )
     if ( Options.dump_reswords_hash )
         printf("---------------------------\n");
     if ( Options.quiet == FALSE ) {
+        for( i = 0, curr = 0; i < PH_SLOTS; i++ )
+            if ( perf_table[i].token && !( ResWordTable[perf_table[i].token].flags & RWF_HIDDEN ) )
+                curr++;
+        printf( "reserved words static table: %u of %u slots valid\n", curr, PH_SLOTS );
         printf( "reserved words hash table: %u items, max items/line=%u ", count, max );
         printf( "[0=%u 1=%u %u %u %u %u %u %u]\n", num[0], num[1], num[2], num[3], num[4], num[5], num[6], num[7] );
     }
 }
 #endif
+
+#endif /* MKRESWH */
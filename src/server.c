@@ -0,0 +1,370 @@
+/****************************************************************************
+*
+*  This code is Public Domain.
+*
+*  ========================================================================
+*
+* Description:  resident assembler ( -server and -client, Unix only ).
+*               The server waits for jobs at a Unix domain socket. A job
+*               consists of the cmdline arguments, the current directory
+*               and the environment of the client. The client's stdout
+*               and stderr handles are passed with the job, so the server
+*               writes its output directly to them. When the job is done,
+*               the exit code is returned to the client.
+*               Between jobs, options and cmdline state are reset. The
+*               reserved words table and the include file cache are kept;
+*               the path caches are cleared, since they depend on the
+*               current directory and the file system state.
+*
+****************************************************************************/
+
+#include <setjmp.h>
+#include <signal.h>
+
+#include "globals.h"
+#include "input.h"
+#include "cmdline.h"
+#include "server.h"
+
+#if SERVERSUPP
+
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define JOB_MAGIC    0x424F4A57 /* "WJOB" */
+#define MAX_JOB_SIZE 0x100000   /* max size of job data */
+
+/* a job is a header, followed by a block of strings:
+ * the current directory, the arguments, an empty string,
+ * the environment variables and another empty string.
+ * The header carries the client's stdout and stderr handles.
+ */
+struct job_header {
+    uint_32     magic;
+    uint_32     size;  /* size of string block */
+};
+
+extern char     banner_printed;
+
+static jmp_buf  jobenv;
+static bool     injob;     /* a job is running */
+static int      exitcode;  /* exit code set by ServerExit() */
+static struct global_options dfltoptions; /* options at program start */
+
+/* called instead of exit() if the cmdline can't be processed */
+
+void ServerExit( int rc )
+/***********************/
+{
+    if ( injob ) {
+        exitcode = rc;
+        longjmp( jobenv, 1 );
+    }
+}
+
+/* run <job>; if the cmdline can't be processed ( Fatal(), -h ), just the
+ * job is terminated. Used by the server and by the library ( jwlib.c ).
+ */
+int GuardedJob( int (*job)( char ** ), char **argv )
+/**************************************************/
+{
+    int rc;
+
+    if ( setjmp( jobenv ) == 0 ) {
+        injob = TRUE;
+        rc = job( argv );
+    } else {
+        /* resources are released by CmdlineFini() */
+        CmdlineFini();
+        rc = exitcode;
+    }
+    injob = FALSE;
+    return( rc );
+}
+
+/* read/write a block of data; returns FALSE on error */
+
+static bool ReadData( int fd, void *buffer, size_t size )
+/*******************************************************/
+{
+    ssize_t rc;
+
+    for ( ; size; size -= rc, buffer = (char *)buffer + rc )
+        if ( ( rc = read( fd, buffer, size ) ) <= 0 )
+            return( FALSE );
+    return( TRUE );
+}
+
+static bool WriteData( int fd, const void *buffer, size_t size )
+/**************************************************************/
+{
+    ssize_t rc;
+
+    for ( ; size; size -= rc, buffer = (const char *)buffer + rc )
+        if ( ( rc = write( fd, buffer, size ) ) <= 0 )
+            return( FALSE );
+    return( TRUE );
+}
+
+static bool SetSockName( struct sockaddr_un *addr, const char *name )
+/*******************************************************************/
+{
+    memset( addr, 0, sizeof( struct sockaddr_un ) );
+    addr->sun_family = AF_UNIX;
+    if ( strlen( name ) >= sizeof( addr->sun_path ) ) {
+        errno = ENAMETOOLONG;
+        return( FALSE );
+    }
+    strcpy( addr->sun_path, name );
+    return( TRUE );
+}
+
+/* get the next string of the job's string block */
+
+static char *NextString( char **pp, char *end )
+/*********************************************/
+{
+    char *p = *pp;
+    char *q = memchr( p, NULLC, end - p );
+
+    if ( q == NULL )
+        return( NULL );
+    *pp = q + 1;
+    return( p );
+}
+
+/* run a job. the client's output handles are used as stdout and stderr */
+
+static int RunJob( char *data, uint_32 size, int *fds, int (*job)( char ** ) )
+/****************************************************************************/
+{
+    char *end = data + size;
+    char *cwd;
+    char *args;
+    char *p;
+    char **argv;
+    int argc;
+    int i;
+    int rc;
+
+    if ( ( cwd = NextString( &data, end ) ) == NULL )
+        return( EXIT_FAILURE );
+    args = data;
+    for ( argc = 0; ( p = NextString( &data, end ) ) && *p; argc++ );
+    if ( p == NULL )
+        return( EXIT_FAILURE );
+    if ( ( argv = malloc( ( argc + 2 ) * sizeof( char * ) ) ) == NULL )
+        return( EXIT_FAILURE );
+    /* argv[0] isn't used, it's replaced by the value of JWASM */
+    argv[0] = "";
+    for ( i = 1; i <= argc; i++ )
+        argv[i] = NextString( &args, end );
+    argv[i] = NULL;
+
+    clearenv();
+    while ( ( p = NextString( &data, end ) ) && *p )
+        putenv( p );
+
+    fflush( stdout );
+    fflush( stderr );
+    dup2( fds[0], STDOUT_FILENO );
+    dup2( fds[1], STDERR_FILENO );
+    /* stdout is buffered as it would be in the client */
+    setvbuf( stdout, NULL, isatty( STDOUT_FILENO ) ? _IOLBF : _IOFBF, BUFSIZ );
+
+    memcpy( &Options, &dfltoptions, sizeof( Options ) );
+    banner_printed = FALSE;
+    InputPathCacheFini();
+
+    if ( chdir( cwd ) != 0 ) {
+        EmitErr( CANNOT_OPEN_FILE, cwd, ErrnoStr() );
+        rc = EXIT_FAILURE;
+    } else
+        rc = GuardedJob( job, argv );
+    fflush( stdout );
+    fflush( stderr );
+    clearenv();
+    free( argv );
+    return( rc );
+}
+
+/* get a job from a client and run it */
+
+static void HandleClient( int fd, int (*job)( char ** ) )
+/*******************************************************/
+{
+    struct job_header hdr;
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr hdr;
+        char buffer[CMSG_SPACE( 2 * sizeof( int ) )];
+    } ctrl;
+    int fds[2] = { -1, -1 };
+    int saved[2];
+    char *data;
+    int_32 rc;
+
+    memset( &msg, 0, sizeof( msg ) );
+    iov.iov_base = &hdr;
+    iov.iov_len = sizeof( hdr );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buffer;
+    msg.msg_controllen = sizeof( ctrl.buffer );
+    if ( recvmsg( fd, &msg, 0 ) != sizeof( hdr ) )
+        return;
+    for ( cmsg = CMSG_FIRSTHDR( &msg ); cmsg; cmsg = CMSG_NXTHDR( &msg, cmsg ) )
+        if ( cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+            cmsg->cmsg_len == CMSG_LEN( 2 * sizeof( int ) ) )
+            memcpy( fds, CMSG_DATA( cmsg ), 2 * sizeof( int ) );
+    if ( fds[0] != -1 && hdr.magic == JOB_MAGIC && hdr.size <= MAX_JOB_SIZE &&
+        ( data = malloc( hdr.size ) ) ) {
+        if ( ReadData( fd, data, hdr.size ) ) {
+            saved[0] = dup( STDOUT_FILENO );
+            saved[1] = dup( STDERR_FILENO );
+            rc = RunJob( data, hdr.size, fds, job );
+            dup2( saved[0], STDOUT_FILENO );
+            dup2( saved[1], STDERR_FILENO );
+            close( saved[0] );
+            close( saved[1] );
+            DebugMsg(("HandleClient: job done, rc=%d\n", rc ));
+            WriteData( fd, &rc, sizeof( rc ) );
+        }
+        free( data );
+    }
+    if ( fds[0] != -1 ) {
+        close( fds[0] );
+        close( fds[1] );
+    }
+}
+
+/* run as server. <job> processes a cmdline and returns the exit code.
+ * returns only if the socket can't be created.
+ */
+int RunServer( const char *name, int (*job)( char ** ) )
+/******************************************************/
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    int sfd;
+    int fd;
+
+    memcpy( &dfltoptions, &Options, sizeof( Options ) );
+    if ( SetSockName( &addr, name ) == FALSE ||
+        ( sfd = socket( AF_UNIX, SOCK_STREAM, 0 ) ) == -1 ) {
+        EmitErr( CANNOT_OPEN_FILE, name, ErrnoStr() );
+        return( EXIT_FAILURE );
+    }
+    /* a socket left by a previous server is removed */
+    if ( stat( name, &st ) == 0 && S_ISSOCK( st.st_mode ) )
+        unlink( name );
+    if ( bind( sfd, (struct sockaddr *)&addr, sizeof( addr ) ) == -1 ||
+        listen( sfd, SOMAXCONN ) == -1 ) {
+        EmitErr( CANNOT_OPEN_FILE, name, ErrnoStr() );
+        close( sfd );
+        return( EXIT_FAILURE );
+    }
+    /* a client that has gone must not terminate the server */
+    signal( SIGPIPE, SIG_IGN );
+    for ( ;; ) {
+        if ( ( fd = accept( sfd, NULL, NULL ) ) == -1 ) {
+            if ( errno == EINTR )
+                continue;
+            break;
+        }
+        HandleClient( fd, job );
+        close( fd );
+    }
+    close( sfd );
+    return( EXIT_FAILURE );
+}
+
+/* run as client: send the cmdline to the server and wait for the exit code.
+ * returns -1 if there's no server; then the cmdline is processed locally.
+ */
+int RunClient( const char *name, char **argv )
+/********************************************/
+{
+    extern char **environ;
+    struct sockaddr_un addr;
+    struct job_header hdr;
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr hdr;
+        char buffer[CMSG_SPACE( 2 * sizeof( int ) )];
+    } ctrl;
+    int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+    char cwd[FILENAME_MAX];
+    char **pp;
+    char *data;
+    char *p;
+    int fd;
+    int_32 rc;
+
+    if ( getcwd( cwd, sizeof( cwd ) ) == NULL || SetSockName( &addr, name ) == FALSE ||
+        ( fd = socket( AF_UNIX, SOCK_STREAM, 0 ) ) == -1 )
+        return( -1 );
+    if ( connect( fd, (struct sockaddr *)&addr, sizeof( addr ) ) == -1 ) {
+        DebugMsg(("RunClient: connect(%s) failed\n", name ));
+        close( fd );
+        return( -1 );
+    }
+    /* build the string block */
+    hdr.magic = JOB_MAGIC;
+    hdr.size = strlen( cwd ) + 1 + 1 + 1;
+    for ( pp = argv; *pp; pp++ )
+        hdr.size += strlen( *pp ) + 1;
+    for ( pp = environ; *pp; pp++ )
+        hdr.size += strlen( *pp ) + 1;
+    if ( hdr.size > MAX_JOB_SIZE || ( data = malloc( hdr.size ) ) == NULL ) {
+        close( fd );
+        return( -1 );
+    }
+    p = data;
+    strcpy( p, cwd );
+    p += strlen( p ) + 1;
+    for ( pp = argv; *pp; pp++, p += strlen( p ) + 1 )
+        strcpy( p, *pp );
+    *p++ = NULLC;
+    for ( pp = environ; *pp; pp++, p += strlen( p ) + 1 )
+        strcpy( p, *pp );
+    *p = NULLC;
+
+    memset( &msg, 0, sizeof( msg ) );
+    memset( &ctrl, 0, sizeof( ctrl ) );
+    iov.iov_base = &hdr;
+    iov.iov_len = sizeof( hdr );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl.buffer;
+    msg.msg_controllen = sizeof( ctrl.buffer );
+    cmsg = CMSG_FIRSTHDR( &msg );
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN( 2 * sizeof( int ) );
+    memcpy( CMSG_DATA( cmsg ), fds, 2 * sizeof( int ) );
+
+    fflush( stdout );
+    fflush( stderr );
+    if ( sendmsg( fd, &msg, 0 ) != sizeof( hdr ) || WriteData( fd, data, hdr.size ) == FALSE ) {
+        free( data );
+        close( fd );
+        return( -1 );
+    }
+    free( data );
+    /* if the server has terminated without an exit code, the job has failed */
+    if ( ReadData( fd, &rc, sizeof( rc ) ) == FALSE ) {
+        EmitError( GENERAL_FAILURE );
+        rc = EXIT_FAILURE;
+    }
+    close( fd );
+    return( rc );
+}
+
+#endif
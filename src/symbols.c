@@ -42,25 +42,21 @@
 #include "types.h"
 #include "proc.h"
 #include "input.h"
-
-#if defined(__WATCOMC__) && !defined(__FLAT__)
-#define HASH_MAGNITUDE 12  /* for 16bit model */
-#else
-#define HASH_MAGNITUDE 15  /* is 15 since v1.94, previously 12 */
-#endif
+#include "reswords.h"
 
 /* size of global hash table for symbol table searches. This affects
  * assembly speed.
+ * v2.21: the size is a power of 2 and the table is doubled whenever
+ * the number of symbols exceeds the number of lines.
  */
-#if HASH_MAGNITUDE==12
-#define GHASH_TABLE_SIZE 2003
+#if defined(__WATCOMC__) && !defined(__FLAT__)
+#define GHASH_MIN_SIZE 0x800   /* for 16bit model */
+#define GHASH_MAX_SIZE 0x2000
 #else
-#define GHASH_TABLE_SIZE 8009
+#define GHASH_MIN_SIZE 0x2000
+#define GHASH_MAX_SIZE 0x1000000
 #endif
 
-/* size of local hash table */
-#define LHASH_TABLE_SIZE 127
-
 /* use memcpy()/memcmpi() directly?
  * this may speed-up things, but not with OW.
  * MSVC is a bit faster then.
@@ -82,14 +78,18 @@ extern void   UpdateLineNumber( struct asym *, void * );
 extern void   UpdateWordSize( struct asym *, void * );
 extern void   UpdateCurPC( struct asym *sym, void *p );
 
-static struct asym   *gsym_table[ GHASH_TABLE_SIZE ];
-static struct asym   *lsym_table[ LHASH_TABLE_SIZE ];
+static struct asym   **gsym_table; /* v2.21: allocated by SymInit() */
+static struct asym   *lsym_empty[ LHASH_TABLE_SIZE ]; /* v2.21: used until the PROC has locals */
+static struct asym   **lsym_table = lsym_empty; /* v2.21: the current PROC's local table */
+static unsigned      gsym_mask;   /* size of global hash table - 1 */
+static unsigned      gsym_grown;  /* number of times the table has been doubled */
 
 StrCmpFunc SymCmpFunc;
 
 static struct asym   **gsym;      /* pointer into global hash table */
 static struct asym   **lsym;      /* pointer into local hash table */
 static unsigned      SymCount;    /* Number of symbols in global table */
+static uint_32       findhash;    /* v2.21: hash of name of last SymFindHash() */
 static char          szDate[12];  /* value of @Date symbol */
 static char          szTime[12];  /* value of @Time symbol */
 
@@ -143,28 +143,43 @@ static const struct eqitem eqtab[] = {
     { "@WordSize", 0,                   UpdateWordSize, NULL }, /* must be last (see SymInit()) */
 };
 
-static unsigned int hashpjw( const char *s )
-/******************************************/
+/* v2.21: double the size of the global hash table.
+ * The order of the items in a line is preserved.
+ */
+static void GrowGlobalTable( void )
+/*********************************/
 {
-    unsigned h;
-    unsigned g;
+    struct asym **old = gsym_table;
+    struct asym **tail;
+    struct asym *sym;
+    struct asym *next;
+    unsigned size = gsym_mask + 1;
+    unsigned i;
 
-#if HASH_MAGNITUDE==12
-    for( h = 0; *s; ++s ) {
-        h = (h << 4) + (*s | ' ');
-        g = h & ~0x0fff;
-        h ^= g;
-        h ^= g >> 12;
-    }
-#else
-    for( h = 0; *s; ++s ) {
-        h = (h << 5) + (*s | ' ');
-        g = h & ~0x7fff;
-        h ^= g;
-        h ^= g >> 15;
+    DebugMsg(("GrowGlobalTable: %u symbols, size %u -> %u\n", SymCount, size, size * 2 ));
+    gsym_mask = size * 2 - 1;
+    gsym_table = MemAlloc( size * 2 * sizeof( struct asym * ) );
+    memset( gsym_table, 0, size * 2 * sizeof( struct asym * ) );
+    for( i = 0; i < size; i++ ) {
+        for( sym = old[i]; sym; sym = next ) {
+            next = sym->nextitem;
+            sym->nextitem = NULL;
+            for( tail = &gsym_table[ sym->hashval & gsym_mask ]; *tail; tail = &((*tail)->nextitem ) );
+            *tail = sym;
+        }
     }
-#endif
-    return( h );
+    MemFree( old );
+    gsym_grown++;
+}
+
+/* add a symbol to the global table; gsym has been set by SymFind() */
+
+static void AddGlobal( struct asym *sym )
+/***************************************/
+{
+    *gsym = sym;
+    if ( ++SymCount > gsym_mask && gsym_mask < GHASH_MAX_SIZE - 1 )
+        GrowGlobalTable();
 }
 
 void SymSetCmpFunc( void )
@@ -174,31 +189,15 @@ void SymSetCmpFunc( void )
     return;
 }
 
-/* reset local hash table */
+/* reset local hash table.
+ * v2.21: each PROC has its own table, which is allocated when the
+ * first local symbol is added. Until then, the empty table is active.
+ */
 
 void SymClearLocal( void )
 /************************/
 {
-    memset( &lsym_table, 0, sizeof( lsym_table ) );
-    return;
-}
-
-/* store local hash table in proc's list of local symbols */
-
-void SymGetLocal( struct asym *proc )
-/***********************************/
-{
-    int i;
-    struct dsym  **l = &((struct dsym *)proc)->e.procinfo->labellist;
-
-    for ( i = 0; i < LHASH_TABLE_SIZE; i++ ) {
-        if ( lsym_table[i] ) {
-            *l = (struct dsym *)lsym_table[i];
-            l = &(*l)->e.nextll;
-        }
-    }
-    *l = NULL;
-
+    lsym_table = lsym_empty;
     return;
 }
 
@@ -206,27 +205,40 @@ void SymGetLocal( struct asym *proc )
  * - proc: procedure which will become active.
  * fixme: It might be necessary to reset the "defined" flag
  * for local labels (not for params and locals!). Low priority!
+ * v2.21: just the table pointer is set; previously the table was
+ * saved by SymGetLocal() and restored here.
  */
 
 void SymSetLocal( struct asym *proc )
 /***********************************/
 {
-    int i;
-    struct dsym *l;
+    lsym_table = ((struct dsym *)proc)->e.procinfo->localtab;
+    if ( lsym_table == NULL )
+        lsym_table = lsym_empty;
+    return;
+}
+
+/* v2.21: add a symbol to the local table; <lsym> has been set by
+ * SymFindHash(). The table of CurrProc is created if it doesn't exist yet.
+ */
 
-    SymClearLocal();
-    for ( l = ((struct dsym *)proc)->e.procinfo->labellist; l; l = l->e.nextll ) {
-        DebugMsg1(("SymSetLocal(%s): label=%s\n", proc->name, l->sym.name ));
-        i = hashpjw( l->sym.name ) % LHASH_TABLE_SIZE;
-        lsym_table[i] = &l->sym;
+static void AddLocal( struct asym *sym )
+/**************************************/
+{
+    if ( lsym_table == lsym_empty ) {
+        lsym_table = LclAlloc( LHASH_TABLE_SIZE * sizeof( struct asym * ) );
+        memset( lsym_table, 0, LHASH_TABLE_SIZE * sizeof( struct asym * ) );
+        CurrProc->e.procinfo->localtab = lsym_table;
+        lsym = &lsym_table[ sym->hashval % LHASH_TABLE_SIZE ];
     }
-    return;
+    *lsym = sym;
 }
 
-struct asym *SymAlloc( const char *name )
-/***************************************/
+/* v2.21: hash of name may be known already */
+
+static struct asym *SymAllocHash( const char *name, int len, uint_32 hash )
+/*************************************************************************/
 {
-    int len = strlen( name );
     struct asym *sym;
 
     sym = LclAlloc( sizeof( struct dsym ) );
@@ -237,9 +249,11 @@ struct asym *SymAlloc( const char *name )
     if( len > MAX_ID_LEN ) {
         EmitError( IDENTIFIER_TOO_LONG );
         len = MAX_ID_LEN;
+        hash = GetNameHash( name, len );
     }
 #endif
     sym->name_size = len;
+    sym->hashval = hash;
     sym->list = ModuleInfo.cref;
     sym->mem_type = MT_EMPTY;
     if ( len ) {
@@ -251,40 +265,278 @@ struct asym *SymAlloc( const char *name )
     return( sym );
 }
 
-struct asym *SymFind( const char *name )
-/**************************************/
+struct asym *SymAlloc( const char *name )
+/***************************************/
+{
+    int len = strlen( name );
+
+    return( SymAllocHash( name, len, GetNameHash( name, len ) ) );
+}
+
+#if EQUTABLE
+
+/* v2.21: compact table of numeric equates. Include files define lots of
+ * constants, most of them are never used. As long as such a constant isn't
+ * found by a symbol search, it's just an item of this table; the names are
+ * stored in a string pool and the items of a hash line are chained by index.
+ * A search that finds the item turns it into a symbol ( see EquPromote() ).
+ */
+
+struct equ_item {
+    uint_64 value;
+    uint_32 hash;
+    uint_32 next;      /* index + 1 of next item in hash line, 0 = none */
+    uint_32 name;      /* offset of name in string pool */
+    uint_8  name_size;
+    uint_8  list;      /* value of ModuleInfo.cref when the equate was defined */
+    uint_8  promoted;  /* item has become a symbol */
+};
+
+#define EQU_MIN_SIZE 1024 /* initial number of items and hash lines */
+
+static struct equ_item *equ_items;
+static uint_32         *equ_table; /* hash lines */
+static char            *equ_names; /* string pool */
+static unsigned        equ_cnt;    /* items used */
+static unsigned        equ_max;    /* items allocated */
+static unsigned        equ_live;   /* items not promoted */
+static unsigned        equ_mask;   /* size of hash table - 1 */
+static uint_32         equ_namesize;
+static uint_32         equ_namemax;
+
+static void *EquGrow( void *old, unsigned size, unsigned newsize )
+/****************************************************************/
+{
+    void *p = MemAlloc( newsize );
+
+    if ( old ) {
+        memcpy( p, old, size );
+        MemFree( old );
+    }
+    return( p );
+}
+
+/* turn an item into a symbol; see SetValue() in equate.c */
+
+static struct asym *EquPromote( struct equ_item *item )
+/*****************************************************/
+{
+    struct asym *sym;
+
+    sym = SymAllocHash( equ_names + item->name, item->name_size, item->hash );
+    sym->list = item->list;
+    sym->state = SYM_INTERNAL;
+    sym->isequate = TRUE;
+    sym->isdefined = TRUE;
+    sym->asmpass = PASS_1;
+    sym->uvalue = (uint_32)item->value;
+    sym->value3264 = (int_32)( item->value >> 32 );
+#if INVLINES
+    sym->is_fixed = TRUE;
+#endif
+    item->promoted = TRUE;
+    equ_live--;
+    for( gsym = &gsym_table[ item->hash & gsym_mask ]; *gsym; gsym = &((*gsym)->nextitem ) );
+    AddGlobal( sym );
+    DebugMsg1(("EquPromote(%s): value=%" I64_SPEC "X\n", sym->name, item->value ));
+    return( sym );
+}
+
+/* search the compact table; an item that is found becomes a symbol */
+
+static struct asym *EquFind( const char *name, int len, uint_32 hash )
+/********************************************************************/
+{
+    uint_32 *pi;
+    struct equ_item *item;
+
+    for( pi = &equ_table[ hash & equ_mask ]; *pi; pi = &item->next ) {
+        item = &equ_items[ *pi - 1 ];
+        if ( hash == item->hash && len == item->name_size && SYMCMP( name, equ_names + item->name, len ) == 0 ) {
+            *pi = item->next;
+            return( EquPromote( item ) );
+        }
+    }
+    return( NULL );
+}
+
+/* double the size of the hash table; promoted items aren't chained anymore */
+
+static void EquGrowTable( void )
+/******************************/
+{
+    unsigned i;
+    unsigned size = ( equ_mask + 1 ) * 2;
+
+    MemFree( equ_table );
+    equ_mask = size - 1;
+    equ_table = MemAlloc( size * sizeof( uint_32 ) );
+    memset( equ_table, 0, size * sizeof( uint_32 ) );
+    for( i = equ_cnt; i; i-- ) {
+        struct equ_item *item = &equ_items[ i - 1 ];
+        if ( item->promoted == FALSE ) {
+            item->next = equ_table[ item->hash & equ_mask ];
+            equ_table[ item->hash & equ_mask ] = i;
+        }
+    }
+}
+
+/* add a numeric equate to the compact table.
+ * returns FALSE if the name exists already.
+ */
+
+bool SymAddEquate( const struct asm_tok *tok, uint_64 value )
+/***********************************************************/
+{
+    struct equ_item *item;
+    unsigned len = tok->idlen;
+
+    if ( len == 0 || SymSearchTok( tok ) )
+        return( FALSE );
+
+    if ( equ_cnt == equ_max ) {
+        equ_max = ( equ_max ? equ_max * 2 : EQU_MIN_SIZE );
+        equ_items = EquGrow( equ_items, equ_cnt * sizeof( struct equ_item ), equ_max * sizeof( struct equ_item ) );
+    }
+    if ( equ_namesize + len + 1 > equ_namemax ) {
+        uint_32 newmax = ( equ_namemax ? equ_namemax * 2 : EQU_MIN_SIZE * 16 );
+        equ_names = EquGrow( equ_names, equ_namesize, newmax );
+        equ_namemax = newmax;
+    }
+    if ( equ_table == NULL ) {
+        equ_mask = EQU_MIN_SIZE - 1;
+        equ_table = MemAlloc( EQU_MIN_SIZE * sizeof( uint_32 ) );
+        memset( equ_table, 0, EQU_MIN_SIZE * sizeof( uint_32 ) );
+    }
+
+    item = &equ_items[ equ_cnt++ ];
+    item->value = value;
+    item->hash = tok->hashval;
+    item->name = equ_namesize;
+    item->name_size = len;
+    item->list = ModuleInfo.cref;
+    item->promoted = FALSE;
+    memcpy( equ_names + equ_namesize, tok->string_ptr, len );
+    equ_names[ equ_namesize + len ] = NULLC;
+    equ_namesize += len + 1;
+    item->next = equ_table[ item->hash & equ_mask ];
+    equ_table[ item->hash & equ_mask ] = equ_cnt;
+    equ_live++;
+    if ( equ_cnt > equ_mask )
+        EquGrowTable();
+    return( TRUE );
+}
+
+static void EquFini( void )
+/*************************/
+{
+    if ( equ_items ) {
+        MemFree( equ_items );
+        MemFree( equ_table );
+        MemFree( equ_names );
+    }
+    equ_items = NULL;
+    equ_table = NULL;
+    equ_names = NULL;
+    equ_cnt = equ_max = equ_live = 0;
+    equ_namesize = equ_namemax = 0;
+}
+
+#endif
+
+static struct asym *FindHash( const char *name, int len, uint_32 hash )
+/********************************************************************/
 /* find a symbol in the local/global symbol table,
  * return ptr to next free entry in global table if not found.
  * Note: lsym must be global, thus if the symbol isn't
  * found and is to be added to the local table, there's no
  * second scan necessary.
+ * v2.21: the hash values are compared before the names.
  */
 {
-    int i;
-    int len;
-
-    len = strlen( name );
-    i = hashpjw( name );
+    findhash = hash;
 
     if ( CurrProc ) {
-        for( lsym = &lsym_table[ i % LHASH_TABLE_SIZE ]; *lsym; lsym = &((*lsym)->nextitem ) ) {
-            if ( len == (*lsym)->name_size && SYMCMP( name, (*lsym)->name, len ) == 0 ) {
+        for( lsym = &lsym_table[ hash % LHASH_TABLE_SIZE ]; *lsym; lsym = &((*lsym)->nextitem ) ) {
+            if ( hash == (*lsym)->hashval && len == (*lsym)->name_size && SYMCMP( name, (*lsym)->name, len ) == 0 ) {
                 DebugMsg1(("SymFind(%s): found in local table, state=%u, local=%u\n", name, (*lsym)->state, (*lsym)->scoped ));
                 return( *lsym );
             }
         }
     }
 
-    for( gsym = &gsym_table[ i % GHASH_TABLE_SIZE ]; *gsym; gsym = &((*gsym)->nextitem ) ) {
-        if ( len == (*gsym)->name_size && SYMCMP( name, (*gsym)->name, len ) == 0 ) {
+    for( gsym = &gsym_table[ hash & gsym_mask ]; *gsym; gsym = &((*gsym)->nextitem ) ) {
+        if ( hash == (*gsym)->hashval && len == (*gsym)->name_size && SYMCMP( name, (*gsym)->name, len ) == 0 ) {
             DebugMsg1(("SymFind(%s): found, state=%u memtype=%X lang=%u\n", name, (*gsym)->state, (*gsym)->mem_type, (*gsym)->langtype ));
             return( *gsym );
         }
     }
 
+#if EQUTABLE
+    if ( equ_live )
+        return( EquFind( name, len, hash ) );
+#endif
     return( NULL );
 }
 
+/* v2.21: a PROTO whose parsing has been deferred is completed
+ * as soon as its name is found.
+ */
+
+struct asym *SymFindHash( const char *name, int len, uint_32 hash )
+/*****************************************************************/
+{
+    struct asym *sym = FindHash( name, len, hash );
+#if LAZYPROTO
+    if ( sym && sym->isdeferred ) {
+        /* ParseProc() searches symbols; lsym and gsym must survive */
+        struct asym **oldlsym = lsym;
+        struct asym **oldgsym = gsym;
+
+        CompleteProto( sym );
+        lsym = oldlsym;
+        gsym = oldgsym;
+        findhash = hash;
+    }
+#endif
+    return( sym );
+}
+
+struct asym *SymFind( const char *name )
+/**************************************/
+{
+    int len = strlen( name );
+
+    return( SymFindHash( name, len, GetNameHash( name, len ) ) );
+}
+
+/* v2.21: find a symbol by an identifier token; the tokenizer has
+ * supplied the hash value and the size of the name.
+ */
+
+struct asym *SymSearchTok( const struct asm_tok *tok )
+/****************************************************/
+{
+    if ( tok->token == T_ID && tok->idlen )
+        return( SymFindHash( tok->string_ptr, tok->idlen, tok->hashval ) );
+    return( SymFind( tok->string_ptr ) );
+}
+
+/* v2.21: SymSearchTok() that doesn't complete a deferred PROTO;
+ * used where the state of the line doesn't allow to parse another one.
+ */
+
+struct asym *SymPeekTok( const struct asm_tok *tok )
+/**************************************************/
+{
+    int len;
+
+    if ( tok->token == T_ID && tok->idlen )
+        return( FindHash( tok->string_ptr, tok->idlen, tok->hashval ) );
+    len = strlen( tok->string_ptr );
+    return( FindHash( tok->string_ptr, len, GetNameHash( tok->string_ptr, len ) ) );
+}
+
 #if 0
 /* Search a symbol */
 
@@ -295,20 +547,18 @@ struct asym *SymSearch( const char *name )
 }
 #endif
 
-/* SymLookup() creates a global label if it isn't defined yet */
+/* SymLookup() creates a global label if it isn't defined yet.
+ * Lookup() is called with the result of SymFindHash().
+ */
 
-struct asym *SymLookup( const char *name )
-/****************************************/
+static struct asym *Lookup( struct asym *sym, const char *name )
+/**************************************************************/
 {
-    struct asym      *sym;
-
-    sym = SymFind( name );
     if( sym == NULL ) {
-        sym = SymAlloc( name );
+        sym = SymAllocHash( name, strlen( name ), findhash );
         DebugMsg1(("SymLookup(%s): created new symbol, CurrProc=%s\n", name, CurrProc ? CurrProc->sym.name : "NULL" ));
         //sym->next = *gsym;
-        *gsym = sym;
-        ++SymCount;
+        AddGlobal( sym );
     }
 
     DebugMsg1(("SymLookup(%s): found, state=%u, defined=%u\n", name, sym->state, sym->isdefined));
@@ -316,6 +566,20 @@ struct asym *SymLookup( const char *name )
     return( sym );
 }
 
+struct asym *SymLookup( const char *name )
+/****************************************/
+{
+    return( Lookup( SymFind( name ), name ) );
+}
+
+/* v2.21: SymLookup() for an identifier token */
+
+struct asym *SymLookupTok( const struct asm_tok *tok )
+/****************************************************/
+{
+    return( Lookup( SymSearchTok( tok ), tok->string_ptr ) );
+}
+
 /* SymLookupLocal() creates a local label if it isn't defined yet.
  * called by LabelCreate() [see labels.c]
  */
@@ -329,11 +593,11 @@ struct asym *SymLookupLocal( const char *name )
     /* v2.19: don't move a label marked as public if -Zm isn't set */
     //if ( sym == NULL ) {
     if ( sym == NULL || ( sym->ispublic && ModuleInfo.m510 == 0 ) ) {
-        sym = SymAlloc( name );
+        sym = SymAllocHash( name, strlen( name ), findhash );
         sym->scoped = TRUE;
         /* add the label to the local hash table */
         //sym->next = *lsym;
-        *lsym = sym;
+        AddLocal( sym );
         DebugMsg1(("SymLookupLocal(%s): local symbol created in %s\n", name, CurrProc->sym.name));
     } else if( sym->state == SYM_UNDEFINED && sym->scoped == FALSE ) {
         /* if the label was defined due to a FORWARD reference,
@@ -346,7 +610,7 @@ struct asym *SymLookupLocal( const char *name )
         /* add the label to the local hash table */
         //sym->next = *lsym;
         sym->nextitem = NULL;
-        *lsym = sym;
+        AddLocal( sym );
         DebugMsg1(("SymLookupLocal(%s): label moved into %s's local namespace\n", sym->name, CurrProc->sym.name ));
     }
 
@@ -452,8 +716,9 @@ struct asym *SymAddLocal( struct asym *sym, const char *name )
     sym->name_size = strlen( name );
     sym->name = LclAlloc( sym->name_size + 1 );
     memcpy( sym->name, name, sym->name_size + 1 );
+    sym->hashval = findhash;
     sym->nextitem = NULL;
-    *lsym = sym;
+    AddLocal( sym );
     return( sym );
 }
 
@@ -470,8 +735,7 @@ struct asym *SymAddGlobal( struct asym *sym )
         return( NULL );
     }
     sym->nextitem = NULL;
-    *gsym = sym;
-    SymCount++;
+    AddGlobal( sym );
     return( sym );
 }
 
@@ -485,9 +749,8 @@ struct asym *SymCreate( const char *name )
         EmitErr( SYMBOL_ALREADY_DEFINED, name );
         return( NULL );
     }
-    sym = SymAlloc( name );
-    *gsym = sym;
-    SymCount++;
+    sym = SymAllocHash( name, strlen( name ), findhash );
+    AddGlobal( sym );
     return( sym );
 }
 
@@ -506,8 +769,8 @@ struct asym *SymLCreate( const char *name )
         EmitErr( SYMBOL_ALREADY_DEFINED, name );
         return( NULL );
     }
-    sym = SymAlloc( name );
-    *lsym = sym;
+    sym = SymAllocHash( name, strlen( name ), findhash );
+    AddLocal( sym );
     return( sym );
 }
 
@@ -517,7 +780,7 @@ void SymMakeAllSymbolsPublic( void )
     int i;
     struct asym  *sym;
 
-    for( i = 0; i < GHASH_TABLE_SIZE; i++ ) {
+    for( i = 0; i <= gsym_mask; i++ ) {
         for( sym = gsym_table[i]; sym; sym = sym->nextitem ) {
             if ( sym->state == SYM_INTERNAL &&
                 /* v2.07: MT_ABS is obsolete */
@@ -535,6 +798,55 @@ void SymMakeAllSymbolsPublic( void )
     }
 }
 
+/* -dsh: display global hash table statistics.
+ * v2.21: available in the release version.
+ */
+
+static void DumpSymbolsHash( void )
+/*********************************/
+{
+    struct asym         *sym;
+    unsigned            i;
+    unsigned            count = 0;
+    unsigned            max = 0;
+    unsigned            num0 = 0;
+    unsigned            num1 = 0;
+    unsigned            num5 = 0;
+    unsigned            num10 = 0;
+    unsigned            curr;
+
+    for( i = 0; i <= gsym_mask; i++ ) {
+        for( sym = gsym_table[i], curr = 0; sym; sym = sym->nextitem )
+            curr++;
+#ifdef DEBUG_OUT
+        if ( curr ) {
+            printf("%4u ", i );
+            for( sym = gsym_table[i]; sym; sym = sym->nextitem ) {
+                printf("%-16s ", sym->name );
+            }
+            printf("\n" );
+        }
+#endif
+        count += curr;
+        if ( curr == 0 )
+            num0++;
+        else if ( curr == 1 )
+            num1++;
+        else if ( curr <= 5 )
+            num5++;
+        else if ( curr <= 10 )
+            num10++;
+        if ( max < curr )
+            max = curr;
+    }
+    printf( "symbol table: %u items, expected %u\n", count, SymCount );
+    printf( "hash table: %u lines (doubled %u times), max items in a line=%u, lines with 0/1/<=5/<=10 items=%u/%u/%u/%u\n",
+           gsym_mask + 1, gsym_grown, max, num0, num1, num5, num10 );
+#if EQUTABLE
+    printf( "compact equates: %u items, %u promoted, %u hash lines\n", equ_cnt, equ_cnt - equ_live, equ_table ? equ_mask + 1 : 0 );
+#endif
+}
+
 #ifdef DEBUG_OUT
 static void DumpSymbols( void );
 #endif
@@ -546,25 +858,18 @@ void SymFini( void )
     unsigned i;
 #endif
 
+    if ( Options.dump_symbols_hash )
+        DumpSymbolsHash();
 #ifdef DEBUG_OUT
-    if ( Options.dump_symbols_hash ) {
-        for( i = 0; i < GHASH_TABLE_SIZE; i++ ) {
-            struct asym  *sym = gsym_table[i];
-            if ( sym ) {
-                printf("%4u ", i );
-                for( ; sym; sym = sym->nextitem ) {
-                    printf("%-16s ", sym->name );
-                }
-                printf("\n" );
-            }
-        }
-    }
     DumpSymbols();
 #endif
+#if EQUTABLE
+    EquFini();
+#endif
 
 #if FASTMEM==0 || defined( DEBUG_OUT )
     /* free the symbol table */
-    for( i = 0; i < GHASH_TABLE_SIZE; i++ ) {
+    for( i = 0; i <= gsym_mask; i++ ) {
         struct asym  *sym;
         struct asym  *next;
         for( sym = gsym_table[i]; sym; ) {
@@ -595,7 +900,15 @@ void SymInit( void )
     /* v2.11: ensure CurrProc is NULL - might be a problem if multiple files are assembled */
     CurrProc = NULL;
 
-    memset( gsym_table, 0, sizeof(gsym_table) );
+    /* v2.21: the global table is allocated; restore the initial size */
+    if ( gsym_table == NULL || gsym_mask != GHASH_MIN_SIZE - 1 ) {
+        if ( gsym_table )
+            MemFree( gsym_table );
+        gsym_mask = GHASH_MIN_SIZE - 1;
+        gsym_table = MemAlloc( GHASH_MIN_SIZE * sizeof( struct asym * ) );
+    }
+    gsym_grown = 0;
+    memset( gsym_table, 0, GHASH_MIN_SIZE * sizeof( struct asym * ) );
 
     time_of_day = time( NULL );
     now = localtime( &time_of_day );
@@ -662,7 +975,7 @@ void SymPassInit( int pass )
      * - SYM_MACRO - macros
      * - SYM_TMACRO - text macros
      */
-    for( i = 0; i < GHASH_TABLE_SIZE; i++ ) {
+    for( i = 0; i <= gsym_mask; i++ ) {
         struct asym *sym;
         for( sym = gsym_table[i]; sym; sym = sym->nextitem ) {
             if ( sym->predefined == FALSE ) {
@@ -692,7 +1005,7 @@ void SymGetAll( struct asym **syms )
     unsigned            i, j;
 
     /* copy symbols to table */
-    for( i = j = 0; i < GHASH_TABLE_SIZE; i++ ) {
+    for( i = j = 0; i <= gsym_mask; i++ ) {
         for( sym = gsym_table[i]; sym; sym = sym->nextitem ) {
             syms[j++] = sym;
         }
@@ -700,6 +1013,32 @@ void SymGetAll( struct asym **syms )
     return;
 }
 
+/* v2.21: make all symbols complete before the table is scanned:
+ * compact equates become symbols, deferred PROTOs are parsed.
+ */
+
+void SymCompleteAll( void )
+/*************************/
+{
+#if LAZYPROTO
+    struct asym *sym;
+    int j;
+#endif
+#if EQUTABLE
+    unsigned i;
+
+    for( i = 0; i < equ_cnt && equ_live; i++ )
+        if ( equ_items[i].promoted == FALSE )
+            EquFind( equ_names + equ_items[i].name, equ_items[i].name_size, equ_items[i].hash );
+#endif
+#if LAZYPROTO
+    for( sym = SymEnum( NULL, &j ); sym; sym = SymEnum( sym, &j ) )
+        if ( sym->isdeferred )
+            CompleteProto( sym );
+#endif
+    return;
+}
+
 /* enum symbols in global hash table.
  * used for codeview symbolic debug output.
  */
@@ -715,7 +1054,7 @@ struct asym *SymEnum( struct asym *sym, int *pi )
     }
 
     /* v2.10: changed from for() to while() */
-    while( sym == NULL && *pi < GHASH_TABLE_SIZE - 1 )
+    while( sym == NULL && (unsigned)*pi < gsym_mask )
         sym = gsym_table[++(*pi)];
 
     //printf("sym=%X, i=%u\n", sym, *pi );
@@ -814,42 +1153,18 @@ static void DumpSymbols( void )
 {
     struct asym         *sym;
     unsigned            i;
-    unsigned            count = 0;
-    unsigned            max = 0;
-    unsigned            num0 = 0;
-    unsigned            num1 = 0;
-    unsigned            num5 = 0;
-    unsigned            num10 = 0;
-    unsigned            curr = 0;
 
     DebugMsg(("DumpSymbols enter\n"));
-    if ( Options.dump_symbols ) {
-        printf( "   # Addr     Type                     Value MT    Ext   P  pName   Name\n" );
-        printf( "--------------------------------------------------------------------------------\n" );
-    }
-    for( i = 0; i < GHASH_TABLE_SIZE; i++ ) {
-        for( sym = gsym_table[i], curr = 0; sym; sym = sym->nextitem ) {
-            curr++;
-            if ( Options.dump_symbols ) {
-                printf("%4u %8p ", i, sym );
-                DumpSymbol( sym );
-            }
+    if ( Options.dump_symbols == FALSE )
+        return;
+    /* v2.21: hash table statistics are displayed by -dsh */
+    printf( "   # Addr     Type                     Value MT    Ext   P  pName   Name\n" );
+    printf( "--------------------------------------------------------------------------------\n" );
+    for( i = 0; i <= gsym_mask; i++ ) {
+        for( sym = gsym_table[i]; sym; sym = sym->nextitem ) {
+            printf("%4u %8p ", i, sym );
+            DumpSymbol( sym );
         }
-        count += curr;
-        if ( curr == 0 )
-            num0++;
-        else if ( curr == 1 )
-            num1++;
-        else if ( curr <= 5 )
-            num5++;
-        else if ( curr <= 10 )
-            num10++;
-        if ( max < curr )
-            max = curr;
-    }
-    if ( Options.quiet == FALSE ) {
-        printf( "symbol table: %u items, expected %u\n", count, SymCount );
-        printf( "hash table: max items in a line=%u, lines with 0/1/<=5/<=10 items=%u/%u/%u/%u, \n", max, num0, num1, num5, num10 );
     }
 }
 #endif
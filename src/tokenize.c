@@ -29,6 +29,7 @@
 ****************************************************************************/
 
 #include <ctype.h>
+#include <stddef.h>
 
 #include "globals.h"
 #include "memalloc.h"
@@ -42,6 +43,14 @@
 #include "fastpass.h"
 #include "myassert.h"
 
+#if SIMDSCAN
+#ifdef __AVX2__
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+#endif
+
 #define CONCATID 0 /* 0=most compatible (see backsl.asm) */
 #define MASMNUMBER 1 /* 1=Masm-compatible number scanning */
 #ifdef __I86__
@@ -75,6 +84,104 @@ extern char    *commentbuffer;
 #define tolower(c) ((c >= 'A' && c <= 'Z') ? c | 0x20 : c )
 #endif
 
+#if SIMDSCAN
+
+/* v2.21: vectorized scanning of identifiers and quoted strings.
+ * A block of 16 ( SSE2 ) or 32 ( AVX2 ) bytes is classified at once.
+ * The loads are aligned, so they never cross a page boundary; bytes
+ * in front of the start position are masked out. The scan ends at
+ * the terminating 00 byte at the latest.
+ */
+#ifdef __AVX2__
+#define VECSIZE 32
+typedef __m256i vec_t;
+#define VLOAD( p )     _mm256_load_si256( (const vec_t *)(p) )
+#define VSET( c )      _mm256_set1_epi8( c )
+#define VEQ( a, b )    _mm256_cmpeq_epi8( a, b )
+#define VGT( a, b )    _mm256_cmpgt_epi8( a, b )
+#define VOR( a, b )    _mm256_or_si256( a, b )
+#define VAND( a, b )   _mm256_and_si256( a, b )
+#define VMASK( v )     (uint_32)_mm256_movemask_epi8( v )
+#define ALLBITS        0xFFFFFFFF
+#else
+#define VECSIZE 16
+typedef __m128i vec_t;
+#define VLOAD( p )     _mm_load_si128( (const vec_t *)(p) )
+#define VSET( c )      _mm_set1_epi8( c )
+#define VEQ( a, b )    _mm_cmpeq_epi8( a, b )
+#define VGT( a, b )    _mm_cmpgt_epi8( a, b )
+#define VOR( a, b )    _mm_or_si128( a, b )
+#define VAND( a, b )   _mm_and_si128( a, b )
+#define VMASK( v )     (uint_32)_mm_movemask_epi8( v )
+#define ALLBITS        0xFFFF
+#endif
+
+/* get bit mask of chars in a block that can't be part of an ID.
+ * same set as is_valid_id_char(): [A-Za-z0-9_@$?]; bytes >= 0x80
+ * are negative in signed compares and hence never valid.
+ */
+static uint_32 NonIdMask( const char *blk )
+/*****************************************/
+{
+    vec_t v = VLOAD( blk );
+    vec_t l = VOR( v, VSET( 0x20 ) );
+    vec_t id;
+
+    id = VAND( VGT( l, VSET( 'a' - 1 ) ), VGT( VSET( 'z' + 1 ), l ) );
+    id = VOR( id, VAND( VGT( v, VSET( '0' - 1 ) ), VGT( VSET( '9' + 1 ), v ) ) );
+    id = VOR( id, VOR( VEQ( v, VSET( '_' ) ), VEQ( v, VSET( '@' ) ) ) );
+    id = VOR( id, VOR( VEQ( v, VSET( '$' ) ), VEQ( v, VSET( '?' ) ) ) );
+    return( ~VMASK( id ) & ALLBITS );
+}
+
+/* get bit mask of chars in a block that are either <delim> or 00 */
+
+static uint_32 DelimMask( const char *blk, vec_t delim )
+/******************************************************/
+{
+    vec_t v = VLOAD( blk );
+    return( VMASK( VOR( VEQ( v, delim ), VEQ( v, VSET( 0 ) ) ) ) );
+}
+
+/* return position of first char that isn't a valid ID char */
+
+static char *ScanId( char *p )
+/****************************/
+{
+    unsigned ofs = (size_t)p & ( VECSIZE - 1 );
+    char *blk = p - ofs;
+    uint_32 mask = NonIdMask( blk ) >> ofs;
+
+    if ( mask )
+        return( p + __builtin_ctz( mask ) );
+    for ( ;; ) {
+        blk += VECSIZE;
+        if ( mask = NonIdMask( blk ) )
+            return( blk + __builtin_ctz( mask ) );
+    }
+}
+
+/* return position of first <delim> or 00 */
+
+static char *ScanDelim( char *p, char delim )
+/*******************************************/
+{
+    unsigned ofs = (size_t)p & ( VECSIZE - 1 );
+    char *blk = p - ofs;
+    vec_t vdelim = VSET( delim );
+    uint_32 mask = DelimMask( blk, vdelim ) >> ofs;
+
+    if ( mask )
+        return( p + __builtin_ctz( mask ) );
+    for ( ;; ) {
+        blk += VECSIZE;
+        if ( mask = DelimMask( blk, vdelim ) )
+            return( blk + __builtin_ctz( mask ) );
+    }
+}
+
+#endif
+
 /* strings for token 0x28 - 0x2F */
 static const short stokstr1[] = {
     '(',')','*','+',',','-','.','/'};
@@ -101,7 +208,7 @@ static bool IsMultiLine( struct asm_tok tokenarray[] )
     i = ( tokenarray[1].token == T_COLON ? 2 : 0 );
     /* don't concat macros */
     if ( tokenarray[i].token == T_ID ) {
-        sym = SymSearch( tokenarray[i].string_ptr );
+        sym = SymPeekTok( &tokenarray[i] ); /* v2.21: the line isn't complete yet */
         if ( sym && ( sym->state == SYM_MACRO )
 #if VARARGML
             && sym->mac_multiline == FALSE  /* v2.11: added */
@@ -224,7 +331,18 @@ static ret_code get_string( struct asm_tok *buf, struct line_status *p )
                 count++; /* count the first quote */
                 break;
             } else {
+#if SIMDSCAN
+                /* v2.21: copy the chars up to the next quote at once */
+                unsigned n = ScanDelim( src, symbol_o ) - src;
+                if ( n > MAX_STRING_LEN - count )
+                    n = MAX_STRING_LEN - count;
+                memcpy( dst, src, n );
+                dst += n;
+                src += n - 1;
+                count += n - 1;
+#else
                 *dst++ = c;
+#endif
             }
         }
         break;  /* end of string marker is the same */
@@ -690,7 +808,6 @@ static ret_code get_id_in_backquotes( struct asm_tok *buf, struct line_status *p
 {
     char *optr = p->output;
     buf->token = T_ID;
-    buf->idarg = 0;
 
     p->input++;         /* strip off the backquotes */
     for( ; *p->input != '`'; ) {
@@ -702,8 +819,10 @@ static ret_code get_id_in_backquotes( struct asm_tok *buf, struct line_status *p
         *optr++ = *p->input++;
     }
     p->input++;         /* skip the terminating '`' */
-    *optr++ = NULLC;
-    p->output = optr;
+    *optr = NULLC;
+    buf->idlen = optr - p->output;
+    buf->hashval = GetNameHash( p->output, buf->idlen );
+    p->output = optr + 1;
     return( NOT_ERROR );
 }
 #endif
@@ -718,13 +837,21 @@ static ret_code get_id( struct asm_tok *buf, struct line_status *p )
     char *dst = p->output;
     int  index;
     unsigned size;
+    uint_32 hash;
 
 #if CONCATID || DOTNAMEX
 continue_scan:
 #endif
+#if SIMDSCAN
+    size = ScanId( src + 1 ) - src;
+    memcpy( dst, src, size );
+    dst += size;
+    src += size;
+#else
     do {
         *dst++ = *src++;
     } while ( is_valid_id_char( *src ) );
+#endif
 #if CONCATID
     /* v2.05: in case there's a backslash right behind
      * the ID, check if a line concatenation is to occur.
@@ -755,6 +882,7 @@ continue_scan:
     if ( size > MAX_ID_LEN ) {
         EmitErr( IDENTIFIER_TOO_LONG );
         dst = p->output + MAX_ID_LEN;
+        size = MAX_ID_LEN;
     }
     *dst++ = NULLC;
 
@@ -766,7 +894,11 @@ continue_scan:
         buf->string_ptr = "?";
         return( NOT_ERROR );
     }
-    index = FindResWord( p->output, size );
+    /* v2.21: the hash is computed once; it's stored in T_ID tokens
+     * and used for the symbol table searches.
+     */
+    hash = GetNameHash( p->output, size );
+    index = FindResWordHash( p->output, size, hash );
     if( index == 0 ) {
         /* if ID begins with a DOT, check for OPTION DOTNAME.
          * if not set, skip the token and return a T_DOT instead!
@@ -780,7 +912,8 @@ continue_scan:
         p->input = src;
         p->output = dst;
         buf->token = T_ID;
-        buf->idarg = 0;
+        buf->idlen = size;
+        buf->hashval = hash;
         return( NOT_ERROR );
     }
     p->input = src;
@@ -820,7 +953,8 @@ continue_scan:
                 ( InstrTable[index].cpu & P_EXT_MASK ) > ( ModuleInfo.curr_cpu & P_EXT_MASK )) {
 #endif
                 buf->token = T_ID;
-                buf->idarg = 0;
+                buf->idlen = size;
+                buf->hashval = hash;
                 return( NOT_ERROR );
             }
         }
@@ -865,7 +999,8 @@ continue_scan:
         DebugMsg(("get_id: error, unknown type in SpecialTable[%u]=%u\n", index, SpecialTable[index].type ));
         /**/myassert( 0 );
         buf->token = T_ID;
-        buf->idarg = 0;
+        buf->idlen = size;
+        buf->hashval = hash;
         break;
     }
     return( NOT_ERROR );
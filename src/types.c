@@ -23,6 +23,7 @@
 #include "listing.h"
 #include "fastpass.h"
 #include "myassert.h"
+#include "reswords.h"
 
 /* v2.04: changed to 0 */
 //#define ANYNAME 1 /* fixme: this probably should be changed to 0 */
@@ -72,20 +73,129 @@ struct asym *CreateTypeSymbol( struct asym *sym, const char *name, bool global )
         ((struct dsym *)sym)->e.structinfo = si = LclAlloc( sizeof( struct struct_info ) );
         si->head = NULL;
         si->tail = NULL;
+#if STRUCTINDEX
+        si->index = NULL;
+#endif
         si->alignment = 0;
         si->flags = 0;
     }
     return( sym );
 }
 
-/* search a name in a struct's fieldlist */
+#if STRUCTINDEX
 
-struct asym *SearchNameInStruct( const struct asym *tstruct, const char *name, uint_32 *poffset, int level )
-/**********************************************************************************************************/
+#define MIN_INDEXED 8 /* smaller structs are scanned linearly */
+
+/* count the names in a struct's fieldlist, including the names
+ * of anonymous members. returns -1 if nesting is too deep.
+ */
+
+static int CountMembers( const struct asym *tstruct, int level )
+/**************************************************************/
+{
+    struct sfield *fl;
+    int cnt = 0;
+    int n;
+
+    if ( level >= MAX_STRUCT_NESTING )
+        return( -1 );
+    for ( fl = ((struct dsym *)tstruct)->e.structinfo->head; fl; fl = fl->next ) {
+        if ( *( fl->sym.name ) == NULLC ) {
+            if ( fl->sym.state == SYM_TYPE )
+                n = CountMembers( &fl->sym, level + 1 );
+            else if ( fl->sym.mem_type == MT_TYPE )
+                n = CountMembers( fl->sym.type, level + 1 );
+            else
+                n = 0;
+            if ( n < 0 )
+                return( -1 );
+            cnt += n;
+        } else
+            cnt++;
+    }
+    return( cnt );
+}
+
+/* add the names of a struct's fieldlist to the index.
+ * The order is the one used by the linear scan, so if a name
+ * exists more than once, the first one is found.
+ */
+
+static void AddMembers( struct mbr_index *idx, const struct asym *tstruct, uint_32 offset )
+/*****************************************************************************************/
+{
+    struct sfield *fl;
+    unsigned i;
+
+    for ( fl = ((struct dsym *)tstruct)->e.structinfo->head; fl; fl = fl->next ) {
+        if ( *( fl->sym.name ) == NULLC ) {
+            if ( fl->sym.state == SYM_TYPE )
+                AddMembers( idx, &fl->sym, offset + fl->sym.offset );
+            else if ( fl->sym.mem_type == MT_TYPE )
+                AddMembers( idx, fl->sym.type, offset + fl->sym.offset );
+        } else {
+            for ( i = fl->sym.hashval & idx->mask; idx->items[i].sym; i = ( i + 1 ) & idx->mask );
+            idx->items[i].sym = &fl->sym;
+            idx->items[i].hash = fl->sym.hashval;
+            idx->items[i].offset = offset;
+        }
+    }
+}
+
+/* build the name index of a closed STRUCT/UNION.
+ * Called by ENDS or, for types read from a PCH file, by the first search.
+ */
+
+static void BuildIndex( struct dsym *dir )
+/****************************************/
+{
+    struct struct_info *si = dir->e.structinfo;
+    int cnt;
+    unsigned size;
+
+    si->isIndexed = TRUE;
+    cnt = CountMembers( &dir->sym, 0 );
+    if ( cnt < MIN_INDEXED )
+        return;
+    for ( size = MIN_INDEXED * 2; size < (unsigned)cnt * 2; size <<= 1 );
+    si->index = LclAlloc( sizeof( struct mbr_index ) + ( size - 1 ) * sizeof( struct mbr_item ) );
+    si->index->mask = size - 1;
+    memset( si->index->items, 0, size * sizeof( struct mbr_item ) );
+    AddMembers( si->index, &dir->sym, 0 );
+    DebugMsg1(("BuildIndex(%s): %u names, %u slots\n", dir->sym.name, cnt, size ));
+}
+
+#endif
+
+/* search a name in a struct's fieldlist.
+ * v2.21: the hash values are compared before the names.
+ * v2.21: if the struct is closed, the index is used.
+ */
+
+static struct asym *SearchStruct( const struct asym *tstruct, const char *name, int len, uint_32 hash, uint_32 *poffset, int level )
+/**********************************************************************************************************************************/
 {
-    int len = strlen( name );
     struct sfield *fl = ((struct dsym *)tstruct)->e.structinfo->head;
     struct asym *sym = NULL;
+#if STRUCTINDEX
+    struct struct_info *si = ((struct dsym *)tstruct)->e.structinfo;
+    struct mbr_item *item;
+    unsigned i;
+
+    if ( si->isOpen == FALSE && ( tstruct->typekind == TYPE_STRUCT || tstruct->typekind == TYPE_UNION ) ) {
+        if ( si->isIndexed == FALSE )
+            BuildIndex( (struct dsym *)tstruct );
+        if ( si->index ) {
+            for ( i = hash & si->index->mask; ( item = &si->index->items[i] )->sym; i = ( i + 1 ) & si->index->mask )
+                if ( item->hash == hash && item->sym->name_size == len && SymCmpFunc( name, item->sym->name, len ) == 0 ) {
+                    DebugMsg1(("SearchNameInStruct: '%s' found in index of struct %s\n", name, tstruct->name ));
+                    *poffset += item->offset;
+                    return( item->sym );
+                }
+            return( NULL );
+        }
+    }
+#endif
 
     //if (ModuleInfo.oldstructs == TRUE) {
     //    return( SymSearch( name ) );
@@ -101,18 +211,18 @@ struct asym *SearchNameInStruct( const struct asym *tstruct, const char *name, u
         if ( *( fl->sym.name ) == NULLC ) {
             /* there are 2 cases: an anonymous inline struct ... */
             if ( fl->sym.state == SYM_TYPE ) {
-                if ( sym = SearchNameInStruct( &fl->sym, name, poffset, level ) ) {
+                if ( sym = SearchStruct( &fl->sym, name, len, hash, poffset, level ) ) {
                     *poffset += fl->sym.offset;
                     break;
                 }
             /* or an anonymous structured field */
             } else if ( fl->sym.mem_type == MT_TYPE ) {
-                if ( sym = SearchNameInStruct( fl->sym.type, name, poffset, level ) ) {
+                if ( sym = SearchStruct( fl->sym.type, name, len, hash, poffset, level ) ) {
                     *poffset += fl->sym.offset;
                     break;
                 }
             }
-        } else if ( len == fl->sym.name_size && SymCmpFunc( name, fl->sym.name, len ) == 0 ) {
+        } else if ( hash == fl->sym.hashval && len == fl->sym.name_size && SymCmpFunc( name, fl->sym.name, len ) == 0 ) {
             DebugMsg1(("SearchNameInStruct: '%s' found in struct %s\n", name, tstruct->name ));
             sym = &fl->sym;
             break;
@@ -121,6 +231,26 @@ struct asym *SearchNameInStruct( const struct asym *tstruct, const char *name, u
     return( sym );
 }
 
+struct asym *SearchNameInStruct( const struct asym *tstruct, const char *name, uint_32 *poffset, int level )
+/**********************************************************************************************************/
+{
+    int len = strlen( name );
+
+    return( SearchStruct( tstruct, name, len, GetNameHash( name, len ), poffset, level ) );
+}
+
+/* v2.21: SearchNameInStruct() for an identifier token; the tokenizer
+ * has supplied the hash value.
+ */
+
+struct asym *SearchTokInStruct( const struct asym *tstruct, const struct asm_tok *tok, uint_32 *poffset )
+/*******************************************************************************************************/
+{
+    if ( tok->token == T_ID && tok->idlen )
+        return( SearchStruct( tstruct, tok->string_ptr, tok->idlen, tok->hashval, poffset, 0 ) );
+    return( SearchNameInStruct( tstruct, tok->string_ptr, poffset, 0 ) );
+}
+
 /* check if a struct has changed */
 
 static bool AreStructsEqual( const struct dsym *newstr, const struct dsym *oldstr )
@@ -177,6 +307,12 @@ ret_code StructDirective( int i, struct asm_tok tokenarray[] )
 
     DebugMsg1(("StructDirective(%s) enter, i=%u, CurrStruct=%s\n", tokenarray[i].string_ptr, i, CurrStruct ? CurrStruct->sym.name : "NULL" ));
 
+#if INVLINES
+    /* v2.21: a top-level struct definition may be pass-invariant */
+    if ( Parse_Pass == PASS_1 && CurrStruct == NULL )
+        InvBlockStart();
+#endif
+
     /* top level structs/unions must have an identifier at pos 0.
      * for embedded structs, the directive must be at pos 0,
      * an identifier is optional then.
@@ -354,6 +490,9 @@ ret_code StructDirective( int i, struct asm_tok tokenarray[] )
 
     dir->next = CurrStruct;
     CurrStruct = dir;
+#if INVLINES
+    InvLineMark();
+#endif
 
 #if 0 //def DEBUG_OUT
     {
@@ -458,6 +597,11 @@ ret_code EndstructDirective( int i, struct asm_tok tokenarray[] )
     dir->sym.offset = 0;
 
     CurrStruct = dir->next;
+#if STRUCTINDEX
+    /* a redefinition is deleted below, it doesn't need an index */
+    if ( redef_struct == NULL || CurrStruct )
+        BuildIndex( dir );
+#endif
     /* v2.0: add the embedded struct AFTER it has been parsed! */
     if ( i == 1 ) {
         struct asym *sym;
@@ -507,6 +651,11 @@ ret_code EndstructDirective( int i, struct asm_tok tokenarray[] )
     if ( tokenarray[i].token != T_FINAL ) {
         return( EmitErr( SYNTAX_ERROR_EX, tokenarray[i].string_ptr ) );
     }
+#if INVLINES
+    InvLineMark();
+    if ( CurrStruct == NULL )
+        InvBlockEnd();
+#endif
     return( NOT_ERROR );
 }
 
@@ -640,6 +789,7 @@ struct asym *CreateStructField( int loc, struct asm_tok tokenarray[], const char
 
     //sym = SymAlloc( name );
     f->sym.name_size = len;
+    f->sym.hashval = GetNameHash( name, len );
     if ( len ) {
         f->sym.name = LclAlloc( len + 1 );
         memcpy( f->sym.name, name, len );
@@ -875,7 +1025,7 @@ ret_code GetQualifiedType( int *pi, struct asm_tok tokenarray[], struct qualifie
     //if ( type == ST_PTR ) {
     if ( type == EMPTY ) {
         if ( tokenarray[i].token == T_ID && tokenarray[i-1].tokval == T_PTR ) {
-            pti->symtype = SymSearch( tokenarray[i].string_ptr );
+            pti->symtype = SymSearchTok( &tokenarray[i] );
             if ( pti->symtype == NULL || pti->symtype->state == SYM_UNDEFINED )
                 pti->symtype = CreateTypeSymbol( pti->symtype, tokenarray[i].string_ptr, TRUE );
             else if ( pti->symtype->state != SYM_TYPE ) {
@@ -926,7 +1076,7 @@ ret_code GetQualifiedType( int *pi, struct asm_tok tokenarray[], struct qualifie
             }
             return( ERROR );
         }
-        pti->symtype = SymSearch( tokenarray[i].string_ptr );
+        pti->symtype = SymSearchTok( &tokenarray[i] );
         if( pti->symtype == NULL || pti->symtype->state != SYM_TYPE ) {
             DebugMsg(("GetQualifiedType: invalid type : %s\n", tokenarray[i].string_ptr ));
             if ( pti->symtype == NULL || pti->symtype ->state == SYM_UNDEFINED )
@@ -1017,6 +1167,9 @@ ret_code TypedefDirective( int i, struct asm_tok tokenarray[] )
     sym->isdefined = TRUE;
     if ( Parse_Pass > PASS_1 )
         return( NOT_ERROR );
+#if INVLINES
+    InvLineMark(); /* v2.21: nothing is done in pass two */
+#endif
     sym->typekind = TYPE_TYPEDEF;
 
     /* PROTO is special */
@@ -1171,6 +1324,9 @@ ret_code RecordDirective( int i, struct asm_tok tokenarray[] )
 
     if ( Parse_Pass > PASS_1 )
         return( NOT_ERROR );
+#if INVLINES
+    InvLineMark(); /* v2.21: nothing is done in pass two */
+#endif
 
     newr = (struct dsym *)sym;
     newr->sym.typekind = TYPE_RECORD;
@@ -1249,6 +1405,7 @@ ret_code RecordDirective( int i, struct asm_tok tokenarray[] )
             f = LclAlloc( sizeof( struct sfield ) + count );
             memset( f, 0, sizeof( struct sfield ) );
             f->sym.name_size = len;
+            f->sym.hashval = GetNameHash( tokenarray[name_loc].string_ptr, len );
             f->sym.name = LclAlloc( len + 1 );
             memcpy( f->sym.name, tokenarray[name_loc].string_ptr, len + 1 );
             f->sym.list = ModuleInfo.cref;
@@ -1357,6 +1514,10 @@ void DeleteType( struct dsym *dir )
 #endif
             LclFree( curr );
         }
+#if STRUCTINDEX
+    if ( dir->e.structinfo->index )
+        LclFree( dir->e.structinfo->index );
+#endif
     LclFree( dir->e.structinfo );
     return;
 }